@@ -0,0 +1,44 @@
+/*
+ * __common__.js
+ */
+
+const chalk = require('chalk')
+
+module.exports = {
+  measure,
+  skip,
+}
+
+/**
+ * Runs @fn @iterations times (after a short warmup) and prints the throughput
+ * @param {string} name
+ * @param {number} iterations
+ * @param {Function} fn - called with the iteration index
+ * @returns {number} operations per second
+ */
+function measure(name, iterations, fn) {
+  const warmup = Math.min(1000, Math.ceil(iterations / 10))
+  for (let i = 0; i < warmup; i++)
+    fn(i)
+
+  if (global.gc)
+    global.gc()
+
+  const start = process.hrtime()
+  for (let i = 0; i < iterations; i++)
+    fn(i)
+  const [seconds, nanoseconds] = process.hrtime(start)
+
+  const elapsed = seconds + nanoseconds / 1e9
+  const opsPerSecond = iterations / elapsed
+
+  console.log(
+    `${chalk.bold(name)}: ${chalk.green(Math.round(opsPerSecond).toLocaleString())} ops/s`
+    + chalk.gray(` (${iterations} iterations, ${(elapsed * 1000).toFixed(1)}ms)`))
+
+  return opsPerSecond
+}
+
+function skip() {
+  process.exit(222)
+}
@@ -0,0 +1,33 @@
+/*
+ * __run__.js
+ *
+ * Runs every benchmark of this directory, or the ones given as arguments:
+ *   node benchmark/__run__.js [object__construction.js ...]
+ */
+
+const fs = require('fs')
+const path = require('path')
+const child_process = require('child_process')
+
+const args = process.argv.slice(2)
+const files = args.length > 0 ?
+  args.map(f => path.basename(f)) :
+  fs.readdirSync(__dirname).filter(f => !path.basename(f).startsWith('__'))
+
+let failed = false
+
+files.forEach(file => {
+  console.log(`# ${file}`)
+
+  const result = child_process.spawnSync(
+    process.execPath, ['--expose-gc', path.join(__dirname, file)], { stdio: 'inherit' })
+
+  if (result.status === 222)
+    console.log('(skipped)')
+  else if (result.status !== 0)
+    failed = true
+
+  console.log('')
+})
+
+process.exit(failed ? 1 : 0)
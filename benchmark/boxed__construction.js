@@ -0,0 +1,18 @@
+/*
+ * boxed__construction.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const Gdk = gi.require('Gdk', '3.0')
+const common = require('./__common__.js')
+
+const ITERATIONS = 100000
+
+common.measure('new Gtk.Border() (constructor)', ITERATIONS, () => {
+  new Gtk.Border()
+})
+
+common.measure('new Gdk.RGBA() (no constructor)', ITERATIONS, () => {
+  new Gdk.RGBA()
+})
@@ -0,0 +1,26 @@
+/*
+ * object__construction.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+const ITERATIONS = 100000
+
+common.measure('new Gtk.Adjustment()', ITERATIONS, () => {
+  new Gtk.Adjustment()
+})
+
+common.measure('new Gtk.Adjustment({ ... })', ITERATIONS, (i) => {
+  new Gtk.Adjustment({ value: i % 100, lower: 0, upper: 100, stepIncrement: 1 })
+})
+
+common.measure('new Gtk.Adjustment({ ... }) (alternating shapes)', ITERATIONS, (i) => {
+  if (i % 2)
+    new Gtk.Adjustment({ value: 50, upper: 100 })
+  else
+    new Gtk.Adjustment({ lower: 0, upper: 100, pageSize: 10 })
+})
@@ -0,0 +1,21 @@
+/*
+ * object__wrapping.js
+ */
+
+const gi = require('../lib/')
+const Gio = gi.require('Gio', '2.0')
+const Gdk = gi.require('Gdk', '3.0')
+const common = require('./__common__.js')
+
+const ITERATIONS = 100000
+
+common.measure('GObject wrappers (Gio.File.newForPath)', ITERATIONS, () => {
+  Gio.File.newForPath('/tmp')
+})
+
+const color = new Gdk.RGBA()
+color.parse('#ff0000')
+
+common.measure('Boxed wrappers (Gdk.RGBA.copy)', ITERATIONS, () => {
+  color.copy()
+})
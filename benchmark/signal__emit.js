@@ -0,0 +1,29 @@
+/*
+ * signal__emit.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+const ITERATIONS = 100000
+
+const button = new Gtk.Button()
+button.on('clicked', () => {})
+
+common.measure('button.clicked()', ITERATIONS, () => {
+  button.clicked()
+})
+
+common.measure('button.emit("clicked")', ITERATIONS, () => {
+  button.emit('clicked')
+})
+
+const entry = new Gtk.Entry()
+entry.on('insert-at-cursor', () => {})
+
+common.measure('entry.emit("insert-at-cursor", text)', ITERATIONS, () => {
+  entry.emit('insert-at-cursor', 'a')
+})
@@ -4,18 +4,26 @@
             "target_name": "node_gtk",
             "sources": [
                 "src/boxed.cc",
+                "src/bytes.cc",
                 "src/callback.cc",
                 "src/closure.cc",
                 "src/debug.cc",
                 "src/error.cc",
+                "src/field.cc",
+                "src/finalize.cc",
                 "src/function.cc",
                 "src/gi.cc",
                 "src/gobject.cc",
+                "src/intern.cc",
                 "src/loop.cc",
+                "src/memory.cc",
                 "src/param_spec.cc",
+                "src/release.cc",
+                "src/subclass.cc",
                 "src/type.cc",
                 "src/util.cc",
                 "src/value.cc",
+                "src/watch.cc",
             ],
             "include_dirs" : [
                 "<!(node -e \"require('nan')\")"
@@ -37,54 +37,14 @@ function bootstrapGIRepository(GI) {
     }
 }
 
-// We also define GObject#on and friends, to keep NodeJS EventEmitter
-// semantics. They are implemented in terms of the native .connect()
-// and .disconnect() methods.
+// GObject#on and friends, which keep NodeJS EventEmitter semantics, are
+// implemented natively alongside .connect() and .disconnect().
 const GObject = internal.GetBaseClass()
 extendGObject(GObject)
 
 function extendGObject(GObject) {
-    GObject.prototype.on = function on(event, callback) {
-        defineListeners(this)
-
-        if (!this._listeners.has(event))
-            this._listeners.set(event, new WeakMap())
-
-        const fnMap = this._listeners.get(event)
-        const handlerID = this.connect(event, callback)
-        fnMap.set(callback, handlerID)
-    }
-
-    GObject.prototype.off = function off(event, callback) {
-        defineListeners(this)
-
-        if (!this._listeners.has(event))
-            return
-
-        const fnMap = this._listeners.get(event)
-        if (!fnMap.has(callback))
-            return
-
-        const handlerID = fnMap.get(callback)
-        this.disconnect(handlerID)
-        fnMap.delete(callback)
-    }
-
-    GObject.prototype.once = function once(event, callback) {
-        const newCallback = (...args) => {
-            callback(...args)
-            this.off(event, newCallback)
-        }
-        this.on(event, newCallback)
-    }
-
-    function defineListeners(object) {
-        if (object._listeners !== undefined)
-            return
-        Object.defineProperty(object, '_listeners', {
-            value: new Map()
-        })
-    }
+    if (typeof Symbol.dispose === 'symbol')
+        GObject.prototype[Symbol.dispose] = GObject.prototype.release
 }
 
 
@@ -161,33 +121,6 @@ function addVirtualFunction(object, info, implementor) {
     })
 }
 
-function fieldGetter(fieldInfo) {
-    return function() {
-        return internal.StructFieldGetter(this, fieldInfo);
-    };
-}
-
-function fieldSetter(fieldInfo) {
-    return function(value) {
-        return internal.StructFieldSetter(this, fieldInfo, value);
-    };
-}
-
-function addField(object, fieldInfo) {
-    const flags = GI.field_info_get_flags(fieldInfo)
-    const writable = (flags & GI.FieldInfoFlags.WRITABLE) !== 0
-    const readable = (flags & GI.FieldInfoFlags.READABLE) !== 0
-
-    const name = getInfoName(fieldInfo)
-
-    Object.defineProperty(object, name, {
-        configurable: true,
-        enumerable: readable,
-        get: readable ? fieldGetter(fieldInfo) : undefined,
-        set: writable ? fieldSetter(fieldInfo) : undefined
-    })
-}
-
 function propertyGetter(propertyName) {
     return function() {
         return internal.ObjectPropertyGetter(this, propertyName);
@@ -259,6 +192,7 @@ function makeEnum(info) {
 
 function makeObject(info) {
     const constructor = internal.MakeObjectClass(info);
+    Object.defineProperty(constructor, 'gtype', { value: GI.registered_type_info_get_g_type(info) })
 
     loop(info, GI.object_info_get_n_properties, GI.object_info_get_property, (propertyInfo) => {
         addProperty(constructor, propertyInfo)
@@ -305,6 +239,8 @@ function makeBoxed(info) {
 
 function makeUnion(info) {
     const constructor = internal.MakeBoxedClass(info);
+    constructor[structInfo] = info
+    addDispose(constructor)
 
     const nMethods = GI.union_info_get_n_methods(info);
     for (let i = 0; i < nMethods; i++) {
@@ -312,17 +248,23 @@ function makeUnion(info) {
         addFunction(constructor, methodInfo);
     }
 
-    const nFields = GI.union_info_get_n_fields(info);
-    for (let i = 0; i < nFields; i++) {
-        const fieldInfo = GI.union_info_get_field(info, i);
-        addField(constructor.prototype, fieldInfo);
-    }
-
     return constructor
 }
 
+// The struct or union info of boxed classes
+const structInfo = Symbol('structInfo')
+const structLayout = Symbol('structLayout')
+
+function addDispose(constructor) {
+    // Keep a reference to the native release(), a method may shadow it
+    if (typeof Symbol.dispose === 'symbol')
+        constructor.prototype[Symbol.dispose] = constructor.prototype.release
+}
+
 function makeStruct(info) {
     const constructor = internal.MakeBoxedClass(info);
+    constructor[structInfo] = info
+    addDispose(constructor)
 
     const nMethods = GI.struct_info_get_n_methods(info);
     for (let i = 0; i < nMethods; i++) {
@@ -330,12 +272,6 @@ function makeStruct(info) {
         addFunction(constructor, methodInfo);
     }
 
-    const nFields = GI.struct_info_get_n_fields(info);
-    for (let i = 0; i < nFields; i++) {
-        const fieldInfo = GI.struct_info_get_field(info, i);
-        addField(constructor.prototype, fieldInfo);
-    }
-
     return constructor
 }
 
@@ -347,6 +283,7 @@ function makeInterface(info) {
             throw new Error('Cannot instantiate Interface (abstract type)')
         }
     })[0]
+    Object.defineProperty(constructor, 'gtype', { value: GI.registered_type_info_get_g_type(info) })
 
     constructor.properties = []
     loop(info, GI.interface_info_get_n_properties, GI.interface_info_get_property, (propInfo) => {
@@ -544,6 +481,182 @@ function _isLoaded(ns, version) {
     return false;
 }
 
+/**
+ * Watches property changes of GObjects. Changes are recorded natively and
+ * delivered as a single deduplicated batch per main loop iteration, or
+ * every `interval` milliseconds if one is given.
+ * Use `watcher.add(object, [names])` to start watching an object,
+ * `watcher.remove(object)` to stop, and `watcher.close()` to stop everything.
+ * @param {Function} callback - called with an array of `{ object, changedProperties }`
+ * @param {number} [interval=0] - delivery interval in milliseconds
+ * @returns {Watcher} the watcher
+ */
+function watch(callback, interval) {
+    return internal.Watch(callback, interval || 0)
+}
+
+/**
+ * Registers the native size of instances of a type (and of its subtypes),
+ * so that the memory held by their wrappers is reported to the garbage collector.
+ * @param {string} typeName - the GType name, e.g. "GdkPixbuf"
+ * @param {Function} hook - called with a wrapper, returns its native size in bytes
+ */
+function registerExternalSize(typeName, hook) {
+    internal.RegisterExternalSize(typeName, hook)
+}
+
+/**
+ * Removes the size hook registered for a type with `registerExternalSize`
+ * @param {string} typeName - the GType name
+ */
+function unregisterExternalSize(typeName) {
+    internal.UnregisterExternalSize(typeName)
+}
+
+/**
+ * Calls `fn`, then releases every wrapper created during the call (see
+ * `.release()`), except the value returned by `fn`.
+ * @param {Function} fn
+ * @returns {any} the value returned by `fn`
+ */
+function scope(fn) {
+    let result
+    internal.PushReleaseScope()
+    try {
+        result = fn()
+    } finally {
+        internal.PopReleaseScope(result)
+    }
+    return result
+}
+
+/**
+ * Registers a JS class, that extends a GObject class, as a new GType.
+ * Virtual functions of the parent classes and of the implemented interfaces
+ * are implemented by methods named `vfunc_` + the camelCase function name,
+ * e.g. `vfunc_getNItems` for `get_n_items`. Methods are looked up once, at
+ * registration.
+ * @param {Function} klass - the class
+ * @param {Object} [options]
+ * @param {string} [options.GTypeName] - the type name (defaults to the class name)
+ * @param {Function[]} [options.Implements] - the implemented interfaces
+ * @returns {Function} the class
+ */
+function registerClass(klass, options) {
+    options = options || {}
+
+    const parent = Object.getPrototypeOf(klass)
+    if (typeof parent !== 'function' || typeof parent.gtype !== 'number')
+        throw new TypeError('Class must extend a GObject class')
+
+    const name = options.GTypeName || klass.name
+    const interfaces = options.Implements || []
+    const gtype = internal.RegisterClass(name, parent.gtype, interfaces.map(i => i.gtype), klass)
+
+    Object.defineProperty(klass, 'gtype', { value: gtype })
+
+    // Interface properties aren't installed on the new type, only methods
+    interfaces.forEach(interface_ => {
+        interface_.methods.forEach(description => {
+            if (!klass.prototype.hasOwnProperty(description.name))
+                define(klass, description)
+        })
+        interface_.constants.forEach(description => {
+            define(klass, description)
+        })
+    })
+
+    return klass
+}
+
+/**
+ * Returns an ArrayBuffer over the memory of a struct or union instance, e.g.
+ * to read many fields at once with a DataView or typed arrays (see
+ * `getStructLayout`). The buffer keeps the instance alive, but must not be
+ * used once the instance has been released.
+ * @param {Object} instance - a struct or union instance
+ * @returns {ArrayBuffer} the buffer
+ */
+function getStructBuffer(instance) {
+    return internal.GetStructBuffer(instance)
+}
+
+/**
+ * Gives a struct or union received by a signal handler or callback
+ * without ownership its own copy of the native memory right away, rather
+ * than when the handler returns. Not needed to use it later, as those
+ * still alive after the handler are copied anyway.
+ * @param {Object} instance - the struct or union instance
+ * @returns {Object} `instance`
+ */
+function keep(instance) {
+    return internal.KeepBoxed(instance)
+}
+
+/**
+ * Returns the memory layout of a struct or union class:
+ * `{ size, fields: [{ name, offset, size, type, [length], [pointer] }] }`,
+ * where `type` is a type tag (e.g. "gdouble") or a "Namespace.Name", and
+ * fixed-size arrays have the type of their elements and a `length`.
+ * @param {Function} constructor - the struct or union class
+ * @returns {Object} the layout
+ */
+function getStructLayout(constructor) {
+    const info = constructor[structInfo]
+    if (!info)
+        throw new TypeError('Not a struct or union class')
+
+    if (!constructor.hasOwnProperty(structLayout))
+        constructor[structLayout] = internal.GetStructLayout(info)
+    return constructor[structLayout]
+}
+
+/**
+ * Calls `fn` with arrays of structs returned as columns rather than as
+ * arrays of instances: `{ length, <field>: TypedArray, ... }`, with one
+ * typed array per numeric field (64-bit fields are Float64Arrays). Columns
+ * objects are also accepted wherever an array of structs is expected.
+ * @param {Function} fn - the function to call
+ * @returns {any} the return value of `fn`
+ */
+function columnar(fn) {
+    const previous = internal.SetColumnarStructs(true)
+    try {
+        return fn()
+    } finally {
+        internal.SetColumnarStructs(previous)
+    }
+}
+
+/**
+ * Calls `fn` with hash tables returned as `Map`s rather than as objects, so
+ * that keys that aren't strings (numbers, objects) are kept as they are.
+ * Maps are also accepted wherever a hash table is expected.
+ * @param {Function} fn - the function to call
+ * @returns {any} the return value of `fn`
+ */
+function hashAsMap(fn) {
+    const previous = internal.SetHashAsMap(true)
+    try {
+        return fn()
+    } finally {
+        internal.SetHashAsMap(previous)
+    }
+}
+
+/**
+ * Returns internal counters, e.g. `wrappers.objects.live` for the number of
+ * GObject wrappers alive and `wrappers.objects.capacity` for the number of
+ * wrapper records allocated, or `finalization.pending` for the number of
+ * native releases queued by the garbage collector (times are in milliseconds),
+ * or `toggles.GtkLabel` for the reference toggles of GtkLabel objects, or
+ * `strings.hitRate` for the share of unowned strings found in the cache.
+ * @returns {Object} the counters
+ */
+function getStats() {
+    return internal.GetStats()
+}
+
 /**
  * Prepends a path to GObject-Introspection search path (for typelibs)
  * @param {string} path
@@ -568,6 +681,17 @@ function prependLibraryPath(path) {
 // Public API
 exports.require = giRequire
 exports.startLoop = internal.StartLoop
+exports.watch = watch
+exports.registerExternalSize = registerExternalSize
+exports.unregisterExternalSize = unregisterExternalSize
+exports.scope = scope
+exports.registerClass = registerClass
+exports.getStats = getStats
+exports.getStructBuffer = getStructBuffer
+exports.keep = keep
+exports.getStructLayout = getStructLayout
+exports.columnar = columnar
+exports.hashAsMap = hashAsMap
 exports.prependSearchPath = prependSearchPath
 exports.prependLibraryPath = prependLibraryPath
 
@@ -22,4 +22,11 @@ exports.apply = (GLib) => {
         this._userQuit = true
         this._quit()
     }
+
+    GLib.Bytes.fromBuffer = function fromBuffer(buffer) {
+        return internal.BufferToBytes(buffer)
+    }
+    GLib.Bytes.prototype.toBuffer = function toBuffer() {
+        return internal.BytesToBuffer(this)
+    }
 }
@@ -0,0 +1,11 @@
+/*
+ * GdkPixbuf-2.0.js
+ */
+
+const internal = require('../native.js')
+
+exports.apply = (GdkPixbuf) => {
+
+    // Pixel data is the bulk of a pixbuf's memory
+    internal.RegisterExternalSize('GdkPixbuf', pixbuf => pixbuf.getByteLength())
+}
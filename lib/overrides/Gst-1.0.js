@@ -0,0 +1,10 @@
+/*
+ * Gst-1.0.js
+ */
+
+const internal = require('../native.js')
+
+exports.apply = (Gst) => {
+
+    internal.RegisterExternalSize('GstBuffer', buffer => buffer.getSize())
+}
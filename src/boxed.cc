@@ -5,9 +5,14 @@
 #include "boxed.h"
 #include "debug.h"
 #include "error.h"
+#include "field.h"
+#include "finalize.h"
 #include "function.h"
 #include "gi.h"
 #include "gobject.h"
+#include "memory.h"
+#include "release.h"
+#include "slab.h"
 #include "type.h"
 #include "util.h"
 #include "value.h"
@@ -52,24 +57,9 @@ static bool IsConstructor (GIFunctionInfo *info) {
     return (flags & GI_FUNCTION_IS_CONSTRUCTOR) != 0;
 }
 
-static GIFunctionInfo* FindBoxedConstructorCached (GType gtype) {
-    if (gtype == G_TYPE_NONE)
-        return NULL;
-
-    GIFunctionInfo* fn_info = (GIFunctionInfo*) g_type_get_qdata(gtype, GNodeJS::constructor_quark());
-
-    if (fn_info != NULL)
-        return fn_info;
-
-    return NULL;
-}
-
-static GIFunctionInfo* FindBoxedConstructor (GIBaseInfo* info, GType gtype) {
+static GIFunctionInfo* FindBoxedConstructor (GIBaseInfo* info) {
     GIFunctionInfo* fn_info = NULL;
 
-    if ((fn_info = FindBoxedConstructorCached(gtype)) != NULL)
-        return g_base_info_ref (fn_info);
-
     if (GI_IS_STRUCT_INFO (info)) {
         int n_methods = g_struct_info_get_n_methods (info);
         for (int i = 0; i < n_methods; i++) {
@@ -125,18 +115,133 @@ static GIFunctionInfo* FindBoxedConstructor (GIBaseInfo* info, GType gtype) {
         }
     }
 
-    if (fn_info != NULL && gtype != G_TYPE_NONE) {
-        g_type_set_qdata(gtype, GNodeJS::constructor_quark(),
-                g_base_info_ref (fn_info));
+    return fn_info;
+}
+
+/*
+ * Constructors are looked up once per type, and kept as FunctionInfo so
+ * that their invoker is only prepared once. They are stored in the type
+ * qdata, or for types without GType, in a table keyed by the name pointer
+ * of the info (which points into the typelib, so it is the same for every
+ * info of a given type).
+ */
+
+static char noConstructorTag;
+#define NO_CONSTRUCTOR ((FunctionInfo *) &noConstructorTag) // cached when a type has no constructor
+
+static GHashTable *constructorsByName = NULL; // const char* => FunctionInfo*
+
+static FunctionInfo* GetBoxedConstructor (GIBaseInfo* info, GType gtype) {
+    FunctionInfo *func;
+    const char *name = g_base_info_get_name (info);
+
+    if (gtype != G_TYPE_NONE) {
+        func = (FunctionInfo *) g_type_get_qdata (gtype, GNodeJS::constructor_quark());
+    } else {
+        if (constructorsByName == NULL)
+            constructorsByName = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+        func = (FunctionInfo *) g_hash_table_lookup (constructorsByName, name);
+    }
+
+    if (func == NULL) {
+        GIFunctionInfo *fn_info = FindBoxedConstructor (info);
+
+        if (fn_info != NULL) {
+            func = new FunctionInfo (fn_info);
+            g_base_info_unref (fn_info);
+        } else {
+            func = NO_CONSTRUCTOR;
+        }
+
+        if (gtype != G_TYPE_NONE)
+            g_type_set_qdata (gtype, GNodeJS::constructor_quark(), func);
+        else
+            g_hash_table_insert (constructorsByName, (gpointer) name, func);
     }
 
-    return fn_info;
+    return func != NO_CONSTRUCTOR ? func : NULL;
 }
 
 static void BoxedDestroyed(const Nan::WeakCallbackInfo<Boxed> &info);
+static void DetachNestedWrappers(Boxed *box);
+
+static Slab<Boxed> boxedRecords;
+
+/**
+ * Makes @owner live at least as long as @object
+ */
+void KeepAlive(Local<Object> object, Local<Object> owner) {
+    Nan::SetPrivate(object, UTF8("owner"), owner);
+}
+
+/**
+ * @param owner if not empty, the wrapper that owns the memory of @boxed,
+ * which is then never freed by this wrapper
+ * @param borrowed whether @boxed is not owned by this wrapper, even if
+ * there is no @owner (see WrapperFromUnownedBoxed)
+ */
+static void AssociateBoxed(Local<Object> self, void *boxed, unsigned long size, GType gtype, GIBaseInfo *info,
+        Local<Object> owner = Local<Object>(), bool borrowed = false) {
+    self->SetAlignedPointerInInternalField (0, boxed);
+
+    size_t external_size = 0;
+
+    if (!owner.IsEmpty())
+        KeepAlive (self, owner);
+
+    borrowed = borrowed || !owner.IsEmpty();
+
+    if (!borrowed && !GetExternalSize (gtype, boxed, self, &external_size))
+        external_size = size != 0 ? size : Boxed::GetSize (info);
+    AdjustExternalSize (external_size);
+
+    guint32 handle = boxedRecords.Alloc();
+    Boxed *box = boxedRecords.Get(handle);
+    box->data = boxed;
+    box->size = size;
+    box->external_size = external_size;
+    box->g_type = gtype;
+    box->handle = handle;
+    box->borrowed = borrowed;
+    box->scope = NULL;
+    box->owner = NULL;
+    box->info = g_base_info_ref (info);
+    box->persistent.Reset(self);
+    box->persistent.SetWeak(box, BoxedDestroyed, Nan::WeakCallbackType::kParameter);
+
+    self->SetAlignedPointerInInternalField (1, box);
+
+    TrackWrapper (self, WRAPPER_BOXED);
+}
+
+/*
+ * Small structs without constructor nor GType are plain data, stored
+ * inline: their memory is an ArrayBuffer held by the wrapper, so they need
+ * no record, persistent or weak callback, and are freed with the wrapper.
+ * Their internal field 1 holds INLINE_BOXED rather than a record. Types
+ * with a GType keep a record, so that g_boxed_free releases what their
+ * instances hold (e.g. the contents of a GValue).
+ */
+
+#define INLINE_MAX_SIZE 64
+
+static guint64 inlineBoxedTag;
+#define INLINE_BOXED ((Boxed *) &inlineBoxedTag)
+
+static void AssociateInlineBoxed(Local<Object> self, size_t size) {
+    Local<v8::ArrayBuffer> storage = v8::ArrayBuffer::New (Isolate::GetCurrent(), size);
+    Nan::SetPrivate(self, UTF8("storage"), storage);
+
+    self->SetAlignedPointerInInternalField (0, storage->GetContents().Data());
+    self->SetAlignedPointerInInternalField (1, INLINE_BOXED);
+
+    TrackWrapper (self, WRAPPER_BOXED);
+}
 
 static void BoxedConstructor(const Nan::FunctionCallbackInfo<Value> &info) {
-    /* See gobject.cc for how this works */
+    /* User code calling `new Pango.AttrList()`. Wrappers of existing data
+     * are instantiated from the template instead, see NewBoxedWrapper. */
     if (!info.IsConstructCall ()) {
         Nan::ThrowTypeError("Not a construct call");
         return;
@@ -149,96 +254,204 @@ static void BoxedConstructor(const Nan::FunctionCallbackInfo<Value> &info) {
     GIBaseInfo *gi_info = (GIBaseInfo *) External::Cast (*info.Data ())->Value ();
     GType gtype = g_registered_type_info_get_g_type (gi_info);
 
-    if (info[0]->IsExternal ()) {
-        /* The External case. This is how WrapperFromBoxed is called. */
+    FunctionInfo* func = GetBoxedConstructor(gi_info, gtype);
 
-        boxed = External::Cast(*info[0])->Value();
+    if (func != NULL) {
 
-    } else {
-        /* User code calling `new Pango.AttrList()` */
-
-        GIFunctionInfo* fn_info = FindBoxedConstructor(gi_info, gtype);
+        GIArgument return_value;
+        GError *error = NULL;
 
-        if (fn_info != NULL) {
+        auto jsResult = FunctionCall (func, info, &return_value, &error);
 
-            FunctionInfo func(fn_info);
-            GIArgument return_value;
-            GError *error = NULL;
+        if (jsResult.IsEmpty()) {
+            // func->Init() or func->TypeCheck() have thrown
+            return;
+        }
 
-            auto jsResult = FunctionCall (&func, info, &return_value, &error);
+        if (error) {
+            Throw::GError ("Boxed constructor failed", error);
+            g_error_free (error);
+            return;
+        }
 
-            g_base_info_unref (fn_info);
+        boxed = return_value.v_pointer;
 
-            if (jsResult.IsEmpty()) {
-                // func->Init() or func->TypeCheck() have thrown
-                return;
-            }
+    } else if ((size = Boxed::GetSize(gi_info)) != 0) {
+        if (gtype == G_TYPE_NONE && size <= INLINE_MAX_SIZE) {
+            AssociateInlineBoxed (self, size);
+            return;
+        }
 
-            if (error) {
-                Throw::GError ("Boxed constructor failed", error);
-                g_error_free (error);
-                return;
-            }
+        boxed = g_slice_alloc0(size);
 
-            boxed = return_value.v_pointer;
+    } else {
+        Nan::ThrowError("Boxed allocation failed: no constructor found");
+        return;
+    }
 
-        } else if ((size = Boxed::GetSize(gi_info)) != 0) {
-            boxed = g_slice_alloc0(size);
+    if (!boxed) {
+        Nan::ThrowError("Boxed allocation failed");
+        return;
+    }
 
-        } else {
-            Nan::ThrowError("Boxed allocation failed: no constructor found");
-            return;
-        }
+    AssociateBoxed (self, boxed, size, gtype, gi_info);
+}
 
-        if (!boxed) {
-            Nan::ThrowError("Boxed allocation failed");
-            return;
-        }
+/**
+ * Frees the native memory of a boxed
+ * @param size the size of the allocation, if it is not a boxed type
+ */
+void BoxedFreeData(GType gtype, void *data, unsigned long size) {
+    if (G_TYPE_IS_BOXED(gtype)) {
+        g_boxed_free(gtype, data);
+    }
+    else if (size != 0) {
+        // Allocated in ./function.cc @ AllocateArgument
+        g_slice_free1(size, data);
+    }
+    else if (data != NULL) {
+        /*
+         * TODO(find informations on what to do here. Only seems to be reached for GI.Typelib)
+         */
+        warn("boxed possibly not freed");
     }
+}
 
-    self->SetAlignedPointerInInternalField (0, boxed);
+static void BoxedForget(Boxed *box) {
+    AdjustExternalSize (-(int64_t) box->external_size);
 
-    Nan::DefineOwnProperty(self,
-            UTF8("__gtype__"),
-            Nan::New<Number>(gtype),
-            (v8::PropertyAttribute)(v8::PropertyAttribute::ReadOnly | v8::PropertyAttribute::DontEnum)
-    );
+    g_base_info_unref (box->info);
 
-    auto* box = new Boxed();
-    box->data = boxed;
-    box->size = size;
-    box->g_type = gtype;
-    box->persistent = new Nan::Persistent<Object>(self);
-    box->persistent->SetWeak(box, BoxedDestroyed, Nan::WeakCallbackType::kParameter);
+    /* Borrow scopes may still list the record, see ~BorrowScope */
+    box->scope = NULL;
+    box->owner = NULL;
+
+    box->persistent.Reset();
+    boxedRecords.Free(box->handle);
+}
+
+static void BoxedFree(Boxed *box) {
+    if (!box->borrowed)
+        BoxedFreeData (box->g_type, box->data, box->size);
+    BoxedForget (box);
 }
 
 static void BoxedDestroyed(const Nan::WeakCallbackInfo<Boxed> &info) {
     Boxed *box = info.GetParameter();
 
-    if (G_TYPE_IS_BOXED(box->g_type)) {
-        g_boxed_free(box->g_type, box->data);
+    /* Freeing is deferred out of the GC pause, see finalize.cc */
+    if (!box->borrowed)
+        QueueBoxedFree (box->g_type, box->data, box->size);
+    BoxedForget (box);
+}
+
+/**
+ * Frees the boxed held by @wrapper now, rather than when it is garbage
+ * collected. The wrapper is left pointing to NULL, so later uses throw
+ * instead of accessing freed memory.
+ */
+void ReleaseBoxed(Local<Object> wrapper) {
+    if (wrapper->InternalFieldCount() < 2)
+        return;
+
+    Boxed *box = (Boxed *) wrapper->GetAlignedPointerFromInternalField (1);
+
+    if (box == NULL)
+        return;
+
+    wrapper->SetAlignedPointerInInternalField (0, NULL);
+    wrapper->SetAlignedPointerInInternalField (1, NULL);
+
+    /* The storage goes away with the wrapper */
+    if (box == INLINE_BOXED)
+        return;
+
+    if (box->scope != NULL)
+        DetachNestedWrappers (box);
+
+    BoxedFree (box);
+}
+
+/**
+ * Returns an ArrayBuffer over the struct memory of @wrapper, which keeps
+ * @wrapper alive. Throws if the size of the struct is unknown.
+ */
+Local<Value> GetStructBuffer(Local<Object> wrapper) {
+    if (wrapper->InternalFieldCount() < 2) {
+        Nan::ThrowTypeError("Object is not a struct or union");
+        return Local<Value>();
     }
-    else if (box->size != 0) {
-        // Allocated in ./function.cc @ AllocateArgument
-        g_slice_free1(box->size, box->data);
+
+    Boxed *box = (Boxed *) wrapper->GetAlignedPointerFromInternalField (1);
+
+    if (box == NULL) {
+        Nan::ThrowError("Cannot get buffer: instance has been released");
+        return Local<Value>();
     }
-    else if (box->data != NULL) {
-        /*
-         * TODO(find informations on what to do here. Only seems to be reached for GI.Typelib)
-         */
-        warn("boxed possibly not freed");
+
+    void *data;
+    size_t size;
+
+    /* The buffer may outlive a lent wrapper */
+    if (box != INLINE_BOXED && box->scope != NULL) {
+        if (EnsureOwnedBoxed (wrapper) == NULL) {
+            Nan::ThrowError("Cannot get buffer: instance can't be copied");
+            return Local<Value>();
+        }
+        box = (Boxed *) wrapper->GetAlignedPointerFromInternalField (1);
+    }
+
+    if (box == INLINE_BOXED) {
+        Local<v8::ArrayBuffer> storage =
+            Nan::GetPrivate(wrapper, UTF8("storage")).ToLocalChecked().As<v8::ArrayBuffer>();
+
+        /* An alias rather than the storage itself, which must not be detached */
+        data = storage->GetContents().Data();
+        size = storage->ByteLength();
+    } else {
+        data = box->data;
+        size = Boxed::GetSize (box->info);
+    }
+
+    if (size == 0) {
+        char *message = g_strdup_printf("Cannot get buffer: size of %s is unknown",
+                g_base_info_get_name (box->info));
+        Nan::ThrowError(message);
+        g_free(message);
+        return Local<Value>();
     }
 
-    delete box->persistent;
-    delete box;
+    /* Externalized: V8 never frees the memory, the wrapper does */
+    Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New (Isolate::GetCurrent(), data, size);
+    KeepAlive (buffer, wrapper);
+
+    return buffer;
+}
+
+static NAN_METHOD(BoxedRelease) {
+    ReleaseBoxed (info.This());
 }
 
 
+/*
+ * Types without GType have no qdata to hold their template: it is kept in
+ * a table keyed by the name pointer of the info, like their constructor.
+ * Those templates are never freed, as their functions would be recreated
+ * without the methods that lib/ adds to them.
+ */
+
+static GHashTable *templatesByName = NULL; // const char* => Persistent<FunctionTemplate>*
+
 Local<FunctionTemplate> GetBoxedTemplate(GIBaseInfo *info, GType gtype) {
     void *data = NULL;
 
     if (gtype != G_TYPE_NONE) {
         data = g_type_get_qdata(gtype, GNodeJS::template_quark());
+    } else {
+        if (templatesByName == NULL)
+            templatesByName = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+        data = g_hash_table_lookup (templatesByName, g_base_info_get_name (info));
     }
 
     /*
@@ -256,7 +469,17 @@ Local<FunctionTemplate> GetBoxedTemplate(GIBaseInfo *info, GType gtype) {
      */
 
     auto tpl = New<FunctionTemplate>(BoxedConstructor, New<External>(info));
-    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    // 0: the boxed pointer, 1: the Boxed record
+    tpl->InstanceTemplate()->SetInternalFieldCount(2);
+
+    Nan::SetTemplate(tpl->InstanceTemplate(),
+            "__gtype__",
+            Nan::New<Number>(gtype),
+            (v8::PropertyAttribute)(v8::PropertyAttribute::ReadOnly | v8::PropertyAttribute::DontEnum));
+
+    Nan::SetPrototypeMethod(tpl, "release", BoxedRelease);
+
+    AddFieldAccessors (tpl, info);
 
     if (gtype != G_TYPE_NONE) {
         const char *class_name = g_type_name(gtype);
@@ -266,11 +489,16 @@ Local<FunctionTemplate> GetBoxedTemplate(GIBaseInfo *info, GType gtype) {
         tpl->SetClassName (UTF8(class_name));
     }
 
-    if (gtype == G_TYPE_NONE)
-        return tpl;
-
     Isolate *isolate = Isolate::GetCurrent();
     auto *persistent = new v8::Persistent<FunctionTemplate>(isolate, tpl);
+
+    if (gtype == G_TYPE_NONE) {
+        /* The template data points to @info */
+        g_base_info_ref (info);
+        g_hash_table_insert (templatesByName, (gpointer) g_base_info_get_name (info), persistent);
+        return tpl;
+    }
+
     persistent->SetWeak(
             g_base_info_ref(info),
             GNodeJS::ClassDestroyed,
@@ -284,43 +512,272 @@ Local<FunctionTemplate> GetBoxedTemplate(GIBaseInfo *info, GType gtype) {
 Local<Function> MakeBoxedClass(GIBaseInfo *info) {
     GType gtype = g_registered_type_info_get_g_type ((GIRegisteredTypeInfo *) info);
 
-    if (gtype == G_TYPE_NONE) {
-        auto moduleCache = GNodeJS::GetModuleCache();
-        auto ns   = UTF8 (g_base_info_get_namespace (info));
-        auto name = UTF8 (g_base_info_get_name (info));
-
-        if (Nan::HasOwnProperty(moduleCache, ns).FromMaybe(false)) {
-            auto module = Nan::Get(moduleCache, ns).ToLocalChecked()->ToObject();
-
-            if (Nan::HasOwnProperty(module, name).FromMaybe(false)) {
-                auto constructor = Nan::Get(module, name).ToLocalChecked()->ToObject();
-                return Local<Function>::Cast (constructor);
-            }
-        }
-    }
-
     Local<FunctionTemplate> tpl = GetBoxedTemplate (info, gtype);
     return tpl->GetFunction ();
 }
 
-Local<Value> WrapperFromBoxed(GIBaseInfo *info, void *data) {
+/**
+ * Creates a wrapper for @data
+ * @param size the size of @data if it is freed with g_slice_free1, or 0
+ * @param owner if not empty, the wrapper that owns @data
+ * @param borrowed whether the wrapper doesn't own @data
+ */
+static Local<Value> NewBoxedWrapper(GIBaseInfo *info, void *data, unsigned long size,
+        Local<Object> owner, bool borrowed) {
     if (data == NULL)
         return Nan::Null();
 
-    Local<Function> constructor = MakeBoxedClass (info);
+    GType gtype = g_registered_type_info_get_g_type ((GIRegisteredTypeInfo *) info);
 
-    Local<Value> boxed_external = Nan::New<External> (data);
-    Local<Value> args[] = { boxed_external };
+    /*
+     * Every type has a cached template: instantiate it directly, rather
+     * than going through a construct call of BoxedConstructor
+     */
 
-    MaybeLocal<Object> instance = Nan::NewInstance(constructor, 1, args);
+    Local<FunctionTemplate> tpl = GetBoxedTemplate (info, gtype);
+    MaybeLocal<Object> instance = Nan::NewInstance(tpl->InstanceTemplate());
 
-    // FIXME(we should propage failure here)
     if (instance.IsEmpty())
         return Nan::Null();
 
+    AssociateBoxed (instance.ToLocalChecked(), data, size, gtype, info, owner, borrowed);
     return instance.ToLocalChecked();
 }
 
+/**
+ * Creates a wrapper that owns @data (transfer full)
+ */
+Local<Value> WrapperFromBoxed(GIBaseInfo *info, void *data) {
+    return NewBoxedWrapper (info, data, 0, Local<Object>(), false);
+}
+
+/**
+ * Creates a wrapper for @data, which is memory owned by @owner (e.g. a
+ * struct nested in the struct of @owner). The wrapper doesn't free it,
+ * and keeps @owner alive.
+ */
+Local<Value> WrapperFromBorrowedBoxed(GIBaseInfo *info, void *data, Local<Object> owner) {
+    Local<Value> wrapper = NewBoxedWrapper (info, data, 0, owner, true);
+
+    /* A nested wrapper of a lent struct is lent by the same scope, which
+     * may not be the current one (e.g. read in a nested callback) */
+    Boxed *owner_box = (Boxed *) owner->GetAlignedPointerFromInternalField (1);
+
+    if (wrapper->IsObject() && owner_box != NULL && owner_box != INLINE_BOXED && owner_box->scope != NULL)
+        owner_box->scope->Add (wrapper.As<Object>(), owner_box);
+
+    return wrapper;
+}
+
+/**
+ * Creates a wrapper for @data, which the caller keeps owning (transfer
+ * none). Inside a collecting BorrowScope, @data is lent to the wrapper
+ * until the scope ends. Otherwise, the wrapper gets its own copy.
+ */
+Local<Value> WrapperFromUnownedBoxed(GIBaseInfo *info, void *data) {
+    if (data == NULL)
+        return Nan::Null();
+
+    BorrowScope *scope = BorrowScope::current;
+
+    if (scope != NULL && scope->collecting) {
+        Local<Value> wrapper = NewBoxedWrapper (info, data, 0, Local<Object>(), true);
+
+        if (wrapper->IsObject())
+            scope->Add (wrapper.As<Object>());
+
+        return wrapper;
+    }
+
+    GType gtype = g_registered_type_info_get_g_type ((GIRegisteredTypeInfo *) info);
+
+    if (G_TYPE_IS_BOXED (gtype))
+        return NewBoxedWrapper (info, g_boxed_copy (gtype, data), 0, Local<Object>(), false);
+
+    size_t size = Boxed::GetSize (info);
+
+    if (size != 0)
+        return NewBoxedWrapper (info, g_slice_copy (size, data), size, Local<Object>(), false);
+
+    /* Can't be copied: wrap it without owning it */
+    return NewBoxedWrapper (info, data, 0, Local<Object>(), true);
+}
+
+
+/*
+ * Borrow scopes. The records of the wrappers lent in a scope are listed
+ * without keeping the wrappers alive: those collected or released during
+ * the callback cost nothing, those still alive when it returns may have
+ * escaped (stored or captured), and are given a copy of their data.
+ * Nested wrappers (see WrapperFromBorrowedBoxed) are lent by the scope of
+ * the struct they were read from, and follow it when it is copied.
+ */
+
+BorrowScope *BorrowScope::current = NULL;
+
+BorrowScope::BorrowScope () : parent (current), boxes (NULL), collecting (true) {
+    current = this;
+}
+
+/**
+ * @param owner the record of the lent wrapper that @wrapper was read
+ * from, if it is a nested wrapper
+ */
+void BorrowScope::Add (Local<Object> wrapper, Boxed *owner) {
+    Boxed *box = (Boxed *) wrapper->GetAlignedPointerFromInternalField (1);
+    box->scope = this;
+    box->owner = owner;
+
+    if (boxes == NULL)
+        boxes = g_ptr_array_new ();
+    g_ptr_array_add (boxes, box);
+}
+
+/**
+ * Gives @wrapper its own copy of the data it borrowed
+ * @returns false if its type can't be copied
+ */
+static bool CopyBorrowed(Local<Object> wrapper, Boxed *box) {
+    void *copy = NULL;
+    unsigned long size = 0;
+
+    if (G_TYPE_IS_BOXED (box->g_type))
+        copy = g_boxed_copy (box->g_type, box->data);
+    else if ((size = Boxed::GetSize (box->info)) != 0)
+        copy = g_slice_copy (size, box->data);
+
+    if (copy == NULL)
+        return false;
+
+    size_t external_size;
+    if (!GetExternalSize (box->g_type, copy, wrapper, &external_size))
+        external_size = size != 0 ? size : Boxed::GetSize (box->info);
+    AdjustExternalSize (external_size);
+
+    box->data = copy;
+    box->size = size;
+    box->external_size = external_size;
+    box->borrowed = false;
+    box->scope = NULL;
+    box->owner = NULL;
+
+    wrapper->SetAlignedPointerInInternalField (0, copy);
+    return true;
+}
+
+/**
+ * Detaches @wrapper from its data, like a released wrapper
+ */
+static void DetachBorrowed(Local<Object> wrapper, Boxed *box) {
+    wrapper->SetAlignedPointerInInternalField (0, NULL);
+    wrapper->SetAlignedPointerInInternalField (1, NULL);
+    BoxedForget (box);
+}
+
+static bool IsNestedIn(Boxed *box, Boxed *owner) {
+    for (Boxed *parent = box->owner; parent != NULL; parent = parent->owner)
+        if (parent == owner)
+            return true;
+    return false;
+}
+
+/**
+ * Moves the nested wrappers of the lent @box, whose data was @old_data,
+ * to @copy: those within the struct are re-pointed into it, the others
+ * (e.g. read through a pointer field) get their own copy. If @copy is
+ * NULL, they are detached.
+ */
+static void MoveNestedWrappers(Boxed *box, BorrowScope *scope, char *old_data, char *copy) {
+    size_t size = Boxed::GetSize (box->info);
+
+    /* Backwards, so that the owners of a wrapper are moved after it */
+    for (guint i = scope->boxes->len; i-- > 0;) {
+        Boxed *nested = (Boxed *) g_ptr_array_index (scope->boxes, i);
+
+        if (nested->scope != scope || !IsNestedIn (nested, box))
+            continue;
+
+        Local<Object> wrapper = Nan::New (nested->persistent);
+        char *data = (char *) nested->data;
+
+        if (copy != NULL && data >= old_data && data < old_data + size) {
+            nested->data = copy + (data - old_data);
+            nested->scope = NULL;
+            nested->owner = NULL;
+            wrapper->SetAlignedPointerInInternalField (0, nested->data);
+        } else if (copy == NULL || !CopyBorrowed (wrapper, nested)) {
+            DetachBorrowed (wrapper, nested);
+        }
+    }
+}
+
+static void DetachNestedWrappers(Boxed *box) {
+    MoveNestedWrappers (box, box->scope, (char *) box->data, NULL);
+}
+
+/**
+ * Gives the lent @wrapper its own copy of the data it borrowed, with its
+ * nested wrappers, or detaches them if its type can't be copied
+ */
+static void PromoteBorrowed(Local<Object> wrapper) {
+    Boxed *box = (Boxed *) wrapper->GetAlignedPointerFromInternalField (1);
+    BorrowScope *scope = box->scope;
+    char *old_data = (char *) box->data;
+
+    if (CopyBorrowed (wrapper, box)) {
+        MoveNestedWrappers (box, scope, old_data, (char *) box->data);
+    } else {
+        MoveNestedWrappers (box, scope, old_data, NULL);
+        DetachBorrowed (wrapper, box);
+    }
+}
+
+/**
+ * Makes @wrapper own its data if it is lent by a BorrowScope, so that it
+ * can outlive the scope. A nested wrapper is moved with the lent struct
+ * it was read from.
+ * @returns the data of @wrapper, or NULL if it has been released or
+ * couldn't be copied
+ */
+void* EnsureOwnedBoxed(Local<Object> wrapper) {
+    if (wrapper->InternalFieldCount() < 2)
+        return NULL;
+
+    Boxed *box = (Boxed *) wrapper->GetAlignedPointerFromInternalField (1);
+
+    if (box != NULL && box != INLINE_BOXED && box->scope != NULL) {
+        Boxed *root = box;
+        while (root->owner != NULL)
+            root = root->owner;
+
+        PromoteBorrowed (Nan::New (root->persistent));
+    }
+
+    return wrapper->GetAlignedPointerFromInternalField (0);
+}
+
+BorrowScope::~BorrowScope () {
+    current = parent;
+
+    if (boxes == NULL)
+        return;
+
+    Nan::HandleScope scope;
+
+    for (guint i = 0; i < boxes->len; i++) {
+        Boxed *box = (Boxed *) g_ptr_array_index (boxes, i);
+
+        /* Collected, released or kept during the callback, or nested
+         * (moved with its owner) */
+        if (box->scope != this || box->owner != NULL)
+            continue;
+
+        PromoteBorrowed (Nan::New (box->persistent));
+    }
+
+    g_ptr_array_unref (boxes);
+}
+
 void* BoxedFromWrapper(Local<Value> value) {
     Local<Object> object = value->ToObject ();
     g_assert(object->InternalFieldCount() > 0);
@@ -328,4 +785,12 @@ void* BoxedFromWrapper(Local<Value> value) {
     return boxed;
 }
 
+/**
+ * Counts the boxed wrapper records in use, and allocated
+ */
+void GetBoxedWrapperStats (guint32 *live, guint32 *capacity) {
+    *live = boxedRecords.Live ();
+    *capacity = boxedRecords.Capacity ();
+}
+
 };
@@ -16,12 +16,20 @@ using v8::Value;
 
 namespace GNodeJS {
 
+class BorrowScope;
+
 class Boxed {
 public:
     void* data;
     GType g_type;
     unsigned long size;
-    Nan::Persistent<Object> *persistent;
+    size_t external_size; // reported to V8 as external memory
+    guint32 handle;       // in the slab of boxed records (see boxed.cc)
+    bool borrowed;        // doesn't own its data (see WrapperFromBorrowedBoxed)
+    BorrowScope *scope;   // the scope that lends the data, or NULL (see BorrowScope)
+    Boxed *owner;         // for a nested wrapper of a lent struct, the wrapper it was read from
+    GIBaseInfo *info;     // the struct or union info
+    Nan::Persistent<Object> persistent;
 
     static size_t GetSize (GIBaseInfo *boxed_info) ;
 };
@@ -29,6 +37,38 @@ public:
 Local<Function>         MakeBoxedClass   (GIBaseInfo *info);
 Local<FunctionTemplate> GetBoxedTemplate (GIBaseInfo *info, GType gtype);
 Local<Value>            WrapperFromBoxed (GIBaseInfo *info, void *data);
+Local<Value>            WrapperFromBorrowedBoxed (GIBaseInfo *info, void *data, Local<Object> owner);
+Local<Value>            WrapperFromUnownedBoxed  (GIBaseInfo *info, void *data);
+void                    KeepAlive        (Local<Object> object, Local<Object> owner);
+Local<Value>            GetStructBuffer  (Local<Object> wrapper);
+void *                  EnsureOwnedBoxed (Local<Object> wrapper);
 void *                  BoxedFromWrapper (Local<Value>);
+void                    ReleaseBoxed     (Local<Object> wrapper);
+void                    BoxedFreeData    (GType gtype, void *data, unsigned long size);
+void                    GetBoxedWrapperStats (guint32 *live, guint32 *capacity);
+
+/**
+ * Lends the transfer-none boxed arguments of a callback to JS. While the
+ * scope collects, WrapperFromUnownedBoxed wraps them without copying. The
+ * native memory may not outlive the callback: when the scope ends, the
+ * lent wrappers that are still alive (stored or captured) are given their
+ * own copy (see EnsureOwnedBoxed).
+ */
+class BorrowScope {
+public:
+    BorrowScope ();
+    ~BorrowScope ();
+
+    /* Stops collecting, before the JS callback runs */
+    void Seal () { collecting = false; }
+
+    void Add (Local<Object> wrapper, Boxed *owner = NULL);
+
+    static BorrowScope *current;
+
+    BorrowScope *parent;
+    GPtrArray   *boxes;        // Boxed* records lent in this scope, NULL until one is added
+    bool         collecting;
+};
 
 };
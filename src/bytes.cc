@@ -0,0 +1,89 @@
+/*
+ * bytes.cc
+ *
+ * Zero-copy bridge between GBytes and node Buffers. A Buffer made from a
+ * GBytes holds a reference on it until the Buffer is collected. A GBytes
+ * made from an ArrayBufferView keeps the view alive until its free func
+ * runs, which may happen on any thread: the view is then released from
+ * the main loop.
+ */
+
+#include <uv.h>
+
+#include "bytes.h"
+
+namespace GNodeJS {
+
+struct ViewRef {
+    Nan::Persistent<Object> view;
+};
+
+static GThread     *mainThread = NULL;
+static GAsyncQueue *releaseQueue = NULL; // ViewRef*, released from other threads
+static uv_async_t   releaseAsync;
+
+
+static void BufferFreed (char *data, void *hint) {
+    g_bytes_unref ((GBytes *) hint);
+}
+
+/**
+ * Creates a Buffer over the data of @bytes. The data of a GBytes is
+ * immutable: the Buffer must not be written to.
+ */
+Local<Value> BufferFromBytes (GBytes *bytes) {
+    gsize size;
+    gconstpointer data = g_bytes_get_data (bytes, &size);
+
+    if (data == NULL || size == 0)
+        return Nan::NewBuffer (0).ToLocalChecked ();
+
+    return Nan::NewBuffer ((char *) data, size, BufferFreed, g_bytes_ref (bytes)).ToLocalChecked ();
+}
+
+static void ReleaseView (ViewRef *ref) {
+    ref->view.Reset ();
+    delete ref;
+}
+
+static void ReleaseQueuedViews (uv_async_t *handle) {
+    gpointer ref;
+
+    while ((ref = g_async_queue_try_pop (releaseQueue)) != NULL)
+        ReleaseView ((ViewRef *) ref);
+}
+
+static void ViewBytesFreed (gpointer data) {
+    ViewRef *ref = (ViewRef *) data;
+
+    if (g_thread_self () == mainThread) {
+        ReleaseView (ref);
+        return;
+    }
+
+    g_async_queue_push (releaseQueue, ref);
+    uv_async_send (&releaseAsync);
+}
+
+/**
+ * Creates a GBytes over the memory of @view, which must not be modified
+ * while the GBytes is alive
+ */
+GBytes *BytesFromBuffer (Local<Object> view) {
+    if (mainThread == NULL) {
+        mainThread = g_thread_self ();
+        releaseQueue = g_async_queue_new ();
+        uv_async_init (uv_default_loop (), &releaseAsync, ReleaseQueuedViews);
+        uv_unref ((uv_handle_t *) &releaseAsync);
+    }
+
+    Local<v8::ArrayBufferView> array = view.As<v8::ArrayBufferView> ();
+    char *data = (char *) array->Buffer ()->GetContents ().Data () + array->ByteOffset ();
+
+    ViewRef *ref = new ViewRef ();
+    ref->view.Reset (view);
+
+    return g_bytes_new_with_free_func (data, array->ByteLength (), ViewBytesFreed, ref);
+}
+
+};
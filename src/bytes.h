@@ -0,0 +1,20 @@
+/*
+ * bytes.h
+ */
+
+#pragma once
+
+#include <node.h>
+#include <nan.h>
+#include <glib.h>
+
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+namespace GNodeJS {
+
+Local<Value> BufferFromBytes (GBytes *bytes);
+GBytes *     BytesFromBuffer (Local<Object> view);
+
+};
@@ -1,6 +1,7 @@
 #include <glib.h>
 #include <nan.h>
 
+#include "boxed.h"
 #include "callback.h"
 #include "closure.h"
 #include "debug.h"
@@ -83,15 +84,21 @@ void Callback::Call (ffi_cif *cif, void *result, void **args, gpointer user_data
 
     GIArgument **gi_args = reinterpret_cast<GIArgument **>(args);
 
+    /* Boxed arguments are lent to the callback, see boxed.h */
+    BorrowScope borrow_scope;
+
     for (int i = 0; i < n_native_args; i++) {
         GIArgInfo arg_info;
         GITypeInfo arg_type;
         g_callable_info_load_arg (callback->info, i, &arg_info);
         g_arg_info_load_type (&arg_info, &arg_type);
 
-        js_args[i] = GIArgumentToV8 (&arg_type, gi_args[i]);
+        js_args[i] = GIArgumentToV8 (&arg_type, gi_args[i], -1,
+                g_arg_info_get_ownership_transfer (&arg_info));
     }
 
+    borrow_scope.Seal ();
+
     Local<Function> function = Nan::New<Function>(callback->persistent);
     Local<Object> self = Nan::GetCurrentContext()->Global();
 
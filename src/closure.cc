@@ -1,8 +1,11 @@
+#include <string.h>
 #include <glib.h>
 #include <nan.h>
 
+#include "boxed.h"
 #include "closure.h"
 #include "debug.h"
+#include "gi.h"
 #include "loop.h"
 #include "type.h"
 #include "value.h"
@@ -26,6 +29,11 @@ void Closure::Marshal(GClosure *base,
     Closure *closure = (Closure *) base;
     Isolate *isolate = Isolate::GetCurrent ();
 
+    /* A .once() listener re-entered before being disconnected */
+    if (closure->once && closure->fired)
+        return;
+    closure->fired = true;
+
     HandleScope scope(isolate);
     Local<Context> context = Context::New(isolate);
     Context::Scope context_scope(context);
@@ -42,6 +50,9 @@ void Closure::Marshal(GClosure *base,
         Local<Value> js_args[n_js_args];
     #endif
 
+    /* Boxed arguments are lent to the handler, see boxed.h */
+    BorrowScope borrow_scope;
+
     for (uint i = 1; i < argc; i++) {
         GIArgument argument;
         memcpy(&argument, &g_argv[i].data[0], sizeof(GIArgument));
@@ -50,9 +61,12 @@ void Closure::Marshal(GClosure *base,
         g_callable_info_load_arg(closure->info, i - 1, &arg_info);
         g_arg_info_load_type(&arg_info, &type_info);
 
-        js_args[i - 1] = GIArgumentToV8(&type_info, &argument);
+        js_args[i - 1] = GIArgumentToV8(&type_info, &argument, -1,
+                g_arg_info_get_ownership_transfer(&arg_info));
     }
 
+    borrow_scope.Seal();
+
     Local<Object> self = func;
     Local<Value> return_value;
 
@@ -77,10 +91,23 @@ void Closure::Marshal(GClosure *base,
     #ifndef __linux__
         delete[] js_args;
     #endif
+
+    /* The handler may already be gone if the instance has been destroyed
+     * during the call (see Invalidated) */
+    if (closure->once && closure->handler_id != 0)
+        g_signal_handler_disconnect (closure->instance, closure->handler_id);
 }
 
 void Closure::Invalidated (gpointer data, GClosure *base) {
     Closure *closure = (Closure *) base;
+
+    if (closure->instance != NULL) {
+        GPtrArray *listeners = GetListeners (closure->instance);
+        if (listeners != NULL)
+            g_ptr_array_remove (listeners, closure);
+    }
+
+    closure->handler_id = 0;
     closure->~Closure();
 }
 
@@ -94,4 +121,51 @@ GClosure *MakeClosure (Local<Function> function, GICallableInfo* info) {
     return gclosure;
 }
 
+
+/*
+ * Listeners registry. The closures connected with .on() and .once() are
+ * kept in a list on their instance, so that they can be found again by
+ * event and callback, without any bookkeeping on the JS side.
+ */
+
+GPtrArray *GetListeners (GObject *gobject) {
+    return (GPtrArray *) g_object_get_qdata (gobject, GNodeJS::listeners_quark());
+}
+
+/**
+ * Registers @closure, already connected with its handler_id set
+ */
+void AddListener (GObject *gobject, Closure *closure) {
+    GPtrArray *listeners = GetListeners (gobject);
+
+    if (listeners == NULL) {
+        listeners = g_ptr_array_new ();
+        g_object_set_qdata_full (gobject, GNodeJS::listeners_quark(),
+                listeners, (GDestroyNotify) g_ptr_array_unref);
+    }
+
+    closure->instance = gobject;
+    g_ptr_array_add (listeners, closure);
+}
+
+/**
+ * Finds the most recently added listener for @event and @callback
+ */
+Closure *FindListener (GObject *gobject, const char *event, Local<Function> callback) {
+    GPtrArray *listeners = GetListeners (gobject);
+
+    if (listeners == NULL)
+        return NULL;
+
+    for (guint i = listeners->len; i > 0; i--) {
+        Closure *closure = (Closure *) g_ptr_array_index (listeners, i - 1);
+
+        if (strcmp (closure->event, event) == 0
+                && Nan::New (closure->persistent)->StrictEquals (callback))
+            return closure;
+    }
+
+    return NULL;
+}
+
 };
@@ -15,11 +15,22 @@ struct Closure {
     Nan::Persistent<v8::Function> persistent;
     GICallableInfo* info;
 
+    /* Set for listeners registered with .on() and .once() */
+    GObject *instance;
+    char    *event;
+    gulong   handler_id;
+    bool     once;
+    bool     fired;
+
     ~Closure() {
         persistent.Reset();
 
         if (info)
             g_base_info_unref (info);
+        info = NULL;
+
+        g_free (event);
+        event = NULL;
     }
 
     static void Marshal(GClosure *closure,
@@ -33,4 +44,8 @@ struct Closure {
 
 GClosure *MakeClosure(v8::Handle<v8::Function> function, GICallableInfo* info);
 
+void       AddListener    (GObject *gobject, Closure *closure);
+Closure   *FindListener   (GObject *gobject, const char *event, v8::Local<v8::Function> callback);
+GPtrArray *GetListeners   (GObject *gobject);
+
 };
@@ -0,0 +1,587 @@
+/*
+ * field.cc
+ *
+ * Accessors for the fields of structs and unions. Each field is compiled
+ * once, when the class template is created, into a FieldAccessor that
+ * knows its offset and how to read it, and is installed on the prototype.
+ * Nested structs are returned as views on the memory of the parent, and
+ * fixed-size numeric arrays as typed arrays on it; both keep the parent
+ * alive, but are invalid once the parent has been released.
+ *
+ * Arrays of structs can also be converted to and from columns: one typed
+ * array per numeric field, see StructArrayToColumns.
+ */
+
+#include <string.h>
+
+#include "boxed.h"
+#include "field.h"
+#include "gi.h"
+#include "intern.h"
+#include "type.h"
+#include "util.h"
+#include "value.h"
+
+using v8::ArrayBuffer;
+using v8::External;
+using v8::Isolate;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+namespace GNodeJS {
+
+enum FieldKind {
+    FIELD_SCALAR,  // numbers, booleans, enums and flags, stored inline
+    FIELD_POINTER, // strings, objects, boxed and containers, stored as a pointer
+    FIELD_NESTED,  // struct or union stored inline
+    FIELD_ARRAY,   // fixed-size array of numbers, stored inline
+    FIELD_ARRAY_COPY, // fixed-size array of numbers without typed array type, e.g. 64-bit
+    FIELD_COMPLEX, // anything else, e.g. fixed-size arrays of pointers
+};
+
+struct FieldAccessor {
+    GIFieldInfo *info;
+    GITypeInfo  *type_info;
+    FieldKind    kind;
+    int          offset;
+    gsize        size;         // FIELD_SCALAR: storage size, FIELD_NESTED: struct size
+    GIBaseInfo  *interface;    // FIELD_NESTED, and FIELD_POINTER to a struct or union
+    int          length;       // FIELD_ARRAY*: number of elements
+    GITypeTag    element_tag;  // FIELD_ARRAY*: storage type of the elements
+};
+
+static bool IsStructOrUnion (GIBaseInfo *info) {
+    GIInfoType info_type = g_base_info_get_type (info);
+    return info_type == GI_INFO_TYPE_STRUCT
+        || info_type == GI_INFO_TYPE_BOXED
+        || info_type == GI_INFO_TYPE_UNION;
+}
+
+static bool IsNumericElement (GITypeTag tag) {
+    switch (tag) {
+        case GI_TYPE_TAG_BOOLEAN:
+        case GI_TYPE_TAG_INT64:
+        case GI_TYPE_TAG_UINT64:
+        case GI_TYPE_TAG_GTYPE:
+            return true;
+        default:
+            return IsTypedArrayElement (tag);
+    }
+}
+
+static FieldAccessor *CompileField (GIFieldInfo *field_info) {
+    auto *accessor = g_new0 (FieldAccessor, 1);
+    accessor->info = g_base_info_ref (field_info);
+    accessor->type_info = g_field_info_get_type (field_info);
+    accessor->offset = g_field_info_get_offset (field_info);
+
+    GITypeInfo *type_info = accessor->type_info;
+    GITypeTag tag = g_type_info_get_tag (type_info);
+
+    if (g_type_info_is_pointer (type_info)) {
+        accessor->kind = FIELD_POINTER;
+
+        if (tag == GI_TYPE_TAG_INTERFACE) {
+            GIBaseInfo *interface = g_type_info_get_interface (type_info);
+
+            if (IsStructOrUnion (interface))
+                accessor->interface = interface;
+            else
+                g_base_info_unref (interface);
+        }
+
+    } else if (tag == GI_TYPE_TAG_INTERFACE) {
+        GIBaseInfo *interface = g_type_info_get_interface (type_info);
+
+        if (IsStructOrUnion (interface)) {
+            accessor->kind = FIELD_NESTED;
+            accessor->interface = interface;
+            accessor->size = Boxed::GetSize (interface);
+        } else {
+            /* Enums and flags */
+            accessor->kind = FIELD_SCALAR;
+            accessor->size = GetTypeTagSize (GetStorageType (type_info));
+            g_base_info_unref (interface);
+        }
+
+    } else if (tag == GI_TYPE_TAG_ARRAY) {
+        GITypeInfo *element_info = g_type_info_get_param_type (type_info, 0);
+
+        accessor->length = g_type_info_get_array_fixed_size (type_info);
+        accessor->element_tag = GetStorageType (element_info);
+
+        if (accessor->length < 0 || g_type_info_is_pointer (element_info))
+            accessor->kind = FIELD_COMPLEX;
+        else if (IsTypedArrayElement (accessor->element_tag))
+            accessor->kind = FIELD_ARRAY;
+        else if (IsNumericElement (accessor->element_tag))
+            accessor->kind = FIELD_ARRAY_COPY;
+        else
+            accessor->kind = FIELD_COMPLEX;
+
+        g_base_info_unref (element_info);
+
+    } else {
+        accessor->kind = FIELD_SCALAR;
+        accessor->size = GetTypeTagSize (tag);
+    }
+
+    return accessor;
+}
+
+/**
+ * Returns the struct memory of @self, or throws and returns NULL
+ */
+static void *GetStruct (Local<Object> self, FieldAccessor *accessor, const char *action) {
+    if (self->InternalFieldCount () < 2) {
+        Nan::ThrowTypeError ("Object is not a struct or union");
+        return NULL;
+    }
+
+    void *boxed = self->GetAlignedPointerFromInternalField (0);
+
+    if (boxed == NULL) {
+        char *message = g_strdup_printf ("Cannot %s field \"%s\": instance has been released",
+                action, g_base_info_get_name (accessor->info));
+        Nan::ThrowError (message);
+        g_free (message);
+    }
+
+    return boxed;
+}
+
+static void FieldGetter (const Nan::FunctionCallbackInfo<Value> &info) {
+    auto *accessor = (FieldAccessor *) External::Cast (*info.Data ())->Value ();
+    Local<Object> self = info.This ();
+
+    void *boxed = GetStruct (self, accessor, "get");
+    if (boxed == NULL)
+        return;
+
+    void *field = G_STRUCT_MEMBER_P (boxed, accessor->offset);
+
+    switch (accessor->kind) {
+        case FIELD_SCALAR: {
+            GIArgument value = {};
+            memcpy (&value, field, accessor->size);
+            RETURN (GIArgumentToV8 (accessor->type_info, &value));
+            break;
+        }
+        case FIELD_POINTER: {
+            GIArgument value;
+            value.v_pointer = *(gpointer *) field;
+
+            /* The struct owns what the pointer points to */
+            if (accessor->interface != NULL)
+                RETURN (WrapperFromBorrowedBoxed (accessor->interface, value.v_pointer, self));
+            else
+                RETURN (GIArgumentToV8 (accessor->type_info, &value));
+            break;
+        }
+        case FIELD_NESTED:
+            RETURN (WrapperFromBorrowedBoxed (accessor->interface, field, self));
+            break;
+        case FIELD_ARRAY: {
+            /* The typed array may outlive a lent struct */
+            boxed = EnsureOwnedBoxed (self);
+            if (boxed == NULL) {
+                Nan::ThrowError ("Unable to get field (instance can't be copied)");
+                break;
+            }
+            field = G_STRUCT_MEMBER_P (boxed, accessor->offset);
+
+            size_t byte_length = accessor->length * GetTypeTagSize (accessor->element_tag);
+            Local<ArrayBuffer> buffer = ArrayBuffer::New (Isolate::GetCurrent (), field, byte_length);
+            KeepAlive (buffer, self);
+            RETURN (MakeTypedArray (accessor->element_tag, buffer, accessor->length));
+            break;
+        }
+        case FIELD_ARRAY_COPY:
+            RETURN (ArrayToV8 (accessor->type_info, field, accessor->length));
+            break;
+        case FIELD_COMPLEX:
+            Nan::ThrowError ("Unable to get field (complex types not allowed)");
+            break;
+    }
+}
+
+static void FieldSetter (const Nan::FunctionCallbackInfo<Value> &info) {
+    auto *accessor = (FieldAccessor *) External::Cast (*info.Data ())->Value ();
+    Local<Object> self = info.This ();
+    Local<Value> value = info[0];
+
+    void *boxed = GetStruct (self, accessor, "set");
+    if (boxed == NULL)
+        return;
+
+    void *field = G_STRUCT_MEMBER_P (boxed, accessor->offset);
+    bool is_void_pointer = accessor->kind == FIELD_POINTER
+        && g_type_info_get_tag (accessor->type_info) == GI_TYPE_TAG_VOID;
+
+    if (accessor->kind == FIELD_SCALAR || is_void_pointer) {
+        GIArgument arg;
+
+        if (!V8ToGIArgument (accessor->type_info, &arg, value, true)) {
+            char *message = g_strdup_printf ("Couldn't convert value for field '%s'",
+                    g_base_info_get_name (accessor->info));
+            Nan::ThrowTypeError (message);
+            g_free (message);
+            return;
+        }
+
+        if (is_void_pointer)
+            *(gpointer *) field = arg.v_pointer;
+        else
+            memcpy (field, &arg, accessor->size);
+
+    } else if (accessor->kind == FIELD_NESTED) {
+        /* Copies the content of another struct of the same type */
+        GType gtype = g_registered_type_info_get_g_type (accessor->interface);
+
+        if (gtype == G_TYPE_NONE || !ValueIsInstanceOfGType (value, gtype)) {
+            char *message = g_strdup_printf ("Couldn't convert value for field '%s'",
+                    g_base_info_get_name (accessor->info));
+            Nan::ThrowTypeError (message);
+            g_free (message);
+            return;
+        }
+
+        void *source = BoxedFromWrapper (value);
+
+        if (source == NULL) {
+            Nan::ThrowError ("Cannot copy a released instance");
+            return;
+        }
+
+        memmove (field, source, accessor->size);
+
+    } else {
+        Nan::ThrowError ("Unable to set field (complex types not allowed)");
+    }
+}
+
+/**
+ * Installs accessors for the fields of @info (a struct or union info)
+ * on the prototype of @tpl
+ */
+void AddFieldAccessors (Local<FunctionTemplate> tpl, GIBaseInfo *info) {
+    bool is_union = g_base_info_get_type (info) == GI_INFO_TYPE_UNION;
+    int n_fields = is_union ?
+        g_union_info_get_n_fields (info) :
+        g_struct_info_get_n_fields (info);
+
+    for (int i = 0; i < n_fields; i++) {
+        GIFieldInfo *field_info = is_union ?
+            g_union_info_get_field (info, i) :
+            g_struct_info_get_field (info, i);
+
+        GIFieldInfoFlags flags = g_field_info_get_flags (field_info);
+        bool readable = (flags & GI_FIELD_IS_READABLE) != 0;
+        bool writable = (flags & GI_FIELD_IS_WRITABLE) != 0;
+
+        FieldAccessor *accessor = CompileField (field_info);
+        Local<External> data = Nan::New<External> (accessor);
+
+        Local<FunctionTemplate> getter = readable ?
+            Nan::New<FunctionTemplate> (FieldGetter, data) : Local<FunctionTemplate> ();
+        Local<FunctionTemplate> setter = writable ?
+            Nan::New<FunctionTemplate> (FieldSetter, data) : Local<FunctionTemplate> ();
+
+        char *name = Util::ToCamelCase (g_base_info_get_name (field_info));
+
+        tpl->PrototypeTemplate ()->SetAccessorProperty (
+                UTF8(name),
+                getter,
+                setter,
+                readable ? v8::None : v8::DontEnum);
+
+        g_free (name);
+        g_base_info_unref (field_info);
+    }
+}
+
+static char *GetTypeName (GITypeInfo *type_info) {
+    if (g_type_info_get_tag (type_info) == GI_TYPE_TAG_INTERFACE) {
+        GIBaseInfo *interface = g_type_info_get_interface (type_info);
+        GIInfoType interface_type = g_base_info_get_type (interface);
+        char *name;
+
+        if (interface_type == GI_INFO_TYPE_ENUM || interface_type == GI_INFO_TYPE_FLAGS)
+            name = g_strdup (g_type_tag_to_string (GetStorageType (type_info)));
+        else
+            name = g_strdup_printf ("%s.%s",
+                    g_base_info_get_namespace (interface), g_base_info_get_name (interface));
+
+        g_base_info_unref (interface);
+        return name;
+    }
+
+    return g_strdup (g_type_tag_to_string (g_type_info_get_tag (type_info)));
+}
+
+/**
+ * Describes the memory layout of @info (a struct or union info):
+ * { size, fields: [{ name, offset, size, type, [length], [pointer] }] }.
+ * `type` is a type tag (e.g. "gdouble") or a "Namespace.Name"; arrays
+ * have the type of their elements and a `length`.
+ */
+Local<Object> GetStructLayout (GIBaseInfo *info) {
+    bool is_union = g_base_info_get_type (info) == GI_INFO_TYPE_UNION;
+    int n_fields = is_union ?
+        g_union_info_get_n_fields (info) :
+        g_struct_info_get_n_fields (info);
+
+    Local<Object> layout = Nan::New<Object> ();
+    Local<v8::Array> fields = Nan::New<v8::Array> (n_fields);
+
+    for (int i = 0; i < n_fields; i++) {
+        GIFieldInfo *field_info = is_union ?
+            g_union_info_get_field (info, i) :
+            g_struct_info_get_field (info, i);
+        GITypeInfo *type_info = g_field_info_get_type (field_info);
+        Local<Object> field = Nan::New<Object> ();
+
+        char *name = Util::ToCamelCase (g_base_info_get_name (field_info));
+        Nan::Set (field, UTF8("name"), UTF8(name));
+        Nan::Set (field, UTF8("offset"), Nan::New<v8::Number> (g_field_info_get_offset (field_info)));
+        g_free (name);
+
+        bool is_pointer = g_type_info_is_pointer (type_info);
+        int length = g_type_info_get_tag (type_info) == GI_TYPE_TAG_ARRAY && !is_pointer ?
+            g_type_info_get_array_fixed_size (type_info) : -1;
+
+        char *type_name;
+        gsize size;
+
+        if (length >= 0) {
+            GITypeInfo *element_info = g_type_info_get_param_type (type_info, 0);
+            type_name = GetTypeName (element_info);
+            size = length * GetTypeSize (element_info);
+            g_base_info_unref (element_info);
+
+            Nan::Set (field, UTF8("length"), Nan::New<v8::Number> (length));
+        } else {
+            type_name = GetTypeName (type_info);
+            size = GetTypeSize (type_info);
+        }
+
+        Nan::Set (field, UTF8("size"), Nan::New<v8::Number> (size));
+        Nan::Set (field, UTF8("type"), UTF8(type_name));
+        if (is_pointer)
+            Nan::Set (field, UTF8("pointer"), Nan::True ());
+
+        Nan::Set (fields, i, field);
+
+        g_free (type_name);
+        g_base_info_unref (type_info);
+        g_base_info_unref (field_info);
+    }
+
+    Nan::Set (layout, UTF8("size"), Nan::New<v8::Number> (Boxed::GetSize (info)));
+    Nan::Set (layout, UTF8("fields"), fields);
+
+    return layout;
+}
+
+
+/*
+ * Columns. An array of structs is converted to { length, <field>: typed
+ * array, ... } with one typed array per numeric field, in one pass and
+ * without per-element wrappers. 64-bit fields are converted to doubles,
+ * like numbers elsewhere, and other fields are left out.
+ */
+
+struct Column {
+    char      *name;       // camelCase
+    int        offset;
+    GITypeTag  tag;        // storage type of the field
+    GITypeTag  array_tag;  // element type of the typed array
+};
+
+static GHashTable *columnsByName = NULL; // const char* (info name) => GArray* of Column
+
+/**
+ * Returns the columns of @info, computed once per struct: like templates
+ * (see boxed.cc), they are keyed by the name pointer of the info
+ */
+static GArray *GetColumns (GIStructInfo *info) {
+    const char *info_name = g_base_info_get_name (info);
+
+    if (columnsByName == NULL)
+        columnsByName = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    GArray *columns = (GArray *) g_hash_table_lookup (columnsByName, info_name);
+
+    if (columns != NULL)
+        return columns;
+
+    columns = g_array_new (FALSE, FALSE, sizeof (Column));
+    int n_fields = g_struct_info_get_n_fields (info);
+
+    for (int i = 0; i < n_fields; i++) {
+        GIFieldInfo *field_info = g_struct_info_get_field (info, i);
+        GITypeInfo *type_info = g_field_info_get_type (field_info);
+        GITypeTag tag = g_type_info_is_pointer (type_info) ?
+            GI_TYPE_TAG_VOID : GetStorageType (type_info);
+
+        if (IsNumericElement (tag)) {
+            Column column;
+            column.name = Util::ToCamelCase (g_base_info_get_name (field_info));
+            column.offset = g_field_info_get_offset (field_info);
+            column.tag = tag;
+
+            if (tag == GI_TYPE_TAG_BOOLEAN)
+                column.array_tag = GI_TYPE_TAG_INT32;
+            else if (!IsTypedArrayElement (tag))
+                column.array_tag = GI_TYPE_TAG_DOUBLE;
+            else
+                column.array_tag = tag;
+
+            g_array_append_val (columns, column);
+        }
+
+        g_base_info_unref (type_info);
+        g_base_info_unref (field_info);
+    }
+
+    g_hash_table_insert (columnsByName, (gpointer) info_name, columns);
+
+    return columns;
+}
+
+static void ReadColumn (Column *column, void *field, void *values, long i) {
+    switch (column->tag) {
+        case GI_TYPE_TAG_INT64:  ((double *) values)[i] = *(gint64 *) field; break;
+        case GI_TYPE_TAG_UINT64: ((double *) values)[i] = *(guint64 *) field; break;
+        case GI_TYPE_TAG_GTYPE:  ((double *) values)[i] = *(GType *) field; break;
+        default: {
+            gsize size = GetTypeTagSize (column->array_tag);
+            memcpy ((char *) values + i * size, field, size);
+            break;
+        }
+    }
+}
+
+static void WriteColumn (Column *column, void *field, void *values, long i) {
+    switch (column->tag) {
+        case GI_TYPE_TAG_INT64:  *(gint64 *) field = ((double *) values)[i]; break;
+        case GI_TYPE_TAG_UINT64: *(guint64 *) field = ((double *) values)[i]; break;
+        case GI_TYPE_TAG_GTYPE:  *(GType *) field = ((double *) values)[i]; break;
+        default: {
+            gsize size = GetTypeTagSize (column->array_tag);
+            memcpy (field, (char *) values + i * size, size);
+            break;
+        }
+    }
+}
+
+/**
+ * Returns the struct info of @element_info if arrays of it can be
+ * converted to columns, or NULL
+ */
+GIBaseInfo *GetColumnsStructInfo (GITypeInfo *element_info) {
+    if (g_type_info_get_tag (element_info) != GI_TYPE_TAG_INTERFACE)
+        return NULL;
+
+    GIBaseInfo *interface = g_type_info_get_interface (element_info);
+    GIInfoType interface_type = g_base_info_get_type (interface);
+
+    if (interface_type == GI_INFO_TYPE_STRUCT || interface_type == GI_INFO_TYPE_BOXED)
+        return interface;
+
+    g_base_info_unref (interface);
+    return NULL;
+}
+
+/**
+ * Returns the length of @value if it is a columns object, or -1
+ */
+long GetColumnsLength (Local<Value> value) {
+    if (!value->IsObject () || value->IsArray () || value->IsArrayBufferView ())
+        return -1;
+
+    Local<Value> length = Nan::Get (value.As<Object> (), UTF8("length")).ToLocalChecked ();
+
+    if (!length->IsNumber ())
+        return -1;
+
+    return Nan::To<int64_t> (length).FromMaybe (-1);
+}
+
+/**
+ * Converts the @length structs of @info at @data to columns
+ * @param stride the distance between structs
+ * @param pointers whether @data is an array of pointers to the structs
+ */
+Local<Value> StructArrayToColumns (GIBaseInfo *info, void *data, long length, gsize stride, bool pointers) {
+    GArray *columns = GetColumns (info);
+    void **values = g_newa (void *, columns->len);
+    Local<Object> result = Nan::New<Object> ();
+
+    Nan::Set (result, UTF8("length"), Nan::New<v8::Number> (length));
+
+    for (guint c = 0; c < columns->len; c++) {
+        Column *column = &g_array_index (columns, Column, c);
+        auto buffer = ArrayBuffer::New (Isolate::GetCurrent (), length * GetTypeTagSize (column->array_tag));
+
+        values[c] = buffer->GetContents ().Data ();
+        Nan::Set (result, InternString (column->name), MakeTypedArray (column->array_tag, buffer, length));
+    }
+
+    for (long i = 0; i < length; i++) {
+        void *element = pointers ? ((void **) data)[i] : (char *) data + i * stride;
+
+        /* Left as zeros */
+        if (element == NULL)
+            continue;
+
+        for (guint c = 0; c < columns->len; c++) {
+            Column *column = &g_array_index (columns, Column, c);
+            ReadColumn (column, G_STRUCT_MEMBER_P (element, column->offset), values[c], i);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Fills the @length structs of @info at @data, stored inline @stride
+ * bytes apart, from @columns. Missing columns are left as is.
+ * @returns false if a column isn't a typed array of the type of its
+ * field, after throwing
+ */
+bool ColumnsToStructArray (GIBaseInfo *info, Local<Object> columns, void *data, long length, gsize stride) {
+    GArray *fields = GetColumns (info);
+    bool result = true;
+
+    for (guint c = 0; c < fields->len && result; c++) {
+        Column *column = &g_array_index (fields, Column, c);
+        Local<Value> value = Nan::Get (columns, InternString (column->name)).ToLocalChecked ();
+
+        if (value->IsUndefined ())
+            continue;
+
+        if (!IsTypedArrayOf (column->array_tag, value)
+                || (long) value.As<v8::TypedArray> ()->Length () < length) {
+            char *message = g_strdup_printf ("Column \"%s\" must be a %s typed array of length %ld",
+                    column->name, g_type_tag_to_string (column->array_tag), length);
+            Nan::ThrowTypeError (message);
+            g_free (message);
+            result = false;
+            break;
+        }
+
+        Local<v8::TypedArray> array = value.As<v8::TypedArray> ();
+        void *values = (char *) array->Buffer ()->GetContents ().Data () + array->ByteOffset ();
+
+        for (long i = 0; i < length; i++) {
+            void *element = (char *) data + i * stride;
+            WriteColumn (column, G_STRUCT_MEMBER_P (element, column->offset), values, i);
+        }
+    }
+
+    return result;
+}
+
+};
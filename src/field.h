@@ -0,0 +1,24 @@
+/*
+ * field.h
+ */
+
+#pragma once
+
+#include <node.h>
+#include <nan.h>
+#include <girepository.h>
+
+using v8::FunctionTemplate;
+using v8::Local;
+
+namespace GNodeJS {
+
+void          AddFieldAccessors (Local<FunctionTemplate> tpl, GIBaseInfo *info);
+Local<v8::Object> GetStructLayout (GIBaseInfo *info);
+
+GIBaseInfo *  GetColumnsStructInfo (GITypeInfo *element_info);
+long          GetColumnsLength     (Local<v8::Value> value);
+Local<v8::Value> StructArrayToColumns (GIBaseInfo *info, void *data, long length, gsize stride, bool pointers);
+bool          ColumnsToStructArray (GIBaseInfo *info, Local<v8::Object> columns, void *data, long length, gsize stride);
+
+};
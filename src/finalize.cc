@@ -0,0 +1,116 @@
+/*
+ * finalize.cc
+ *
+ * Deferred finalization. Weak callbacks run during GC pauses, where the
+ * last unref of a GObject can run long dispose chains. Instead, they queue
+ * the native release here, and the queue is drained from a uv idle handle
+ * in slices bounded in count and time.
+ */
+
+#include <uv.h>
+
+#include "boxed.h"
+#include "finalize.h"
+
+namespace GNodeJS {
+
+#define SLICE_MAX_ENTRIES 512
+#define SLICE_MAX_TIME_US 1000
+#define SLICE_TIME_CHECK_INTERVAL 32
+
+enum FinalizeKind {
+    FINALIZE_OBJECT,
+    FINALIZE_BOXED,
+};
+
+struct FinalizeEntry {
+    FinalizeKind kind;
+    gpointer     data;
+    GType        gtype;
+    gsize        size;
+};
+
+static GArray *queue = NULL; // FinalizeEntry
+static guint queue_head = 0; // index of the next entry to finalize
+static uv_idle_t idle;
+static FinalizationStats stats = {};
+
+
+static void Finalize (FinalizeEntry *entry) {
+    switch (entry->kind) {
+        case FINALIZE_OBJECT:
+            g_object_unref (entry->data);
+            break;
+        case FINALIZE_BOXED:
+            BoxedFreeData (entry->gtype, entry->data, entry->size);
+            break;
+    }
+}
+
+static void Drain (uv_idle_t *handle) {
+    gint64 start = g_get_monotonic_time ();
+    guint count = 0;
+
+    /* Finalizers may run JS that triggers a GC, which can append
+     * to the queue: entries are copied out before being finalized */
+    while (queue_head < queue->len && count < SLICE_MAX_ENTRIES) {
+        FinalizeEntry entry = g_array_index (queue, FinalizeEntry, queue_head++);
+        Finalize (&entry);
+        count++;
+
+        if (count % SLICE_TIME_CHECK_INTERVAL == 0
+                && g_get_monotonic_time () - start >= SLICE_MAX_TIME_US)
+            break;
+    }
+
+    if (queue_head == queue->len) {
+        g_array_set_size (queue, 0);
+        queue_head = 0;
+        uv_idle_stop (&idle);
+    }
+
+    stats.finalized += count;
+    stats.last_slice_us = g_get_monotonic_time () - start;
+    if (stats.last_slice_us > stats.max_slice_us)
+        stats.max_slice_us = stats.last_slice_us;
+}
+
+static void Queue (FinalizeEntry *entry) {
+    if (queue == NULL) {
+        queue = g_array_new (FALSE, FALSE, sizeof (FinalizeEntry));
+        uv_idle_init (uv_default_loop (), &idle);
+    }
+
+    if (queue_head == queue->len)
+        uv_idle_start (&idle, Drain);
+
+    g_array_append_vals (queue, entry, 1);
+
+    guint pending = queue->len - queue_head;
+    if (pending > stats.max_pending)
+        stats.max_pending = pending;
+}
+
+/**
+ * Drops the reference of a collected wrapper, later
+ */
+void QueueObjectUnref (GObject *gobject) {
+    FinalizeEntry entry = { FINALIZE_OBJECT, gobject, G_TYPE_NONE, 0 };
+    Queue (&entry);
+}
+
+/**
+ * Frees the boxed of a collected wrapper, later
+ * @param size the size of the allocation, if it is not a boxed type
+ */
+void QueueBoxedFree (GType gtype, gpointer data, gsize size) {
+    FinalizeEntry entry = { FINALIZE_BOXED, data, gtype, size };
+    Queue (&entry);
+}
+
+void GetFinalizationStats (FinalizationStats *result) {
+    *result = stats;
+    result->pending = queue != NULL ? queue->len - queue_head : 0;
+}
+
+};
@@ -0,0 +1,23 @@
+/*
+ * finalize.h
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+namespace GNodeJS {
+
+struct FinalizationStats {
+    guint   pending;       // entries waiting in the queue
+    guint   max_pending;   // highest queue length seen
+    guint64 finalized;     // entries released since startup
+    gint64  last_slice_us; // duration of the last drain slice
+    gint64  max_slice_us;  // duration of the longest drain slice
+};
+
+void QueueObjectUnref      (GObject *gobject);
+void QueueBoxedFree        (GType gtype, gpointer data, gsize size);
+void GetFinalizationStats  (FinalizationStats *stats);
+
+};
@@ -6,6 +6,7 @@
 #include "callback.h"
 #include "debug.h"
 #include "error.h"
+#include "field.h"
 #include "function.h"
 #include "gobject.h"
 #include "type.h"
@@ -32,13 +33,20 @@ static void FillArgument(GIArgInfo *arg_info, GIArgument *argument, Local<Value>
     V8ToGIArgument(&type_info, argument, value, may_be_null);
 }
 
-static int GetV8ArrayLength (Local<Value> value) {
-    if (value->IsArray())
+static int GetV8ArrayLength (GITypeInfo *type_info, Local<Value> value) {
+    void *data;
+    long length;
+
+    if (GetArrayBufferViewData(type_info, value, &data, &length))
+        return length;
+    else if (value->IsArray())
         return Local<Array>::Cast (value->ToObject ())->Length();
     else if (value->IsString())
         return value->ToString ()->Length();
     else if (value->IsNull() || value->IsUndefined())
         return 0;
+    else if (GetColumnsLength(value) >= 0)
+        return GetColumnsLength(value);
 
     printf("%s\n", *Nan::Utf8String(value->ToString()));
     g_assert_not_reached();
@@ -123,11 +131,26 @@ Local<Value> FunctionCall (
     GIArgument total_arg_values[func->n_total_args];
     GIArgument *callable_arg_values;
     GError *error_stack = nullptr;
+    StringScratch scratch;
+
+    /* IN arguments pointing to memory the call doesn't own (view or
+     * scratch string). Per call rather than in func->call_parameters,
+     * which a reentrant call of the same function would overwrite. */
+    bool borrowed_args[func->n_callable_args + 1];
+    memset (borrowed_args, 0, sizeof (borrowed_args));
 
     if (func->is_method) {
         GIBaseInfo *container = g_base_info_get_container (gi_info);
         V8ToGIArgument(container, &total_arg_values[0], info.This());
         callable_arg_values = &total_arg_values[1];
+
+        if (total_arg_values[0].v_pointer == NULL) {
+            char *message = g_strdup_printf("Cannot call %s: instance has been released",
+                    g_base_info_get_name(gi_info));
+            Nan::ThrowError(message);
+            g_free(message);
+            return jsReturnValue;
+        }
     } else {
         callable_arg_values = &total_arg_values[0];
     }
@@ -163,12 +186,12 @@ Local<Value> FunctionCall (
             Parameter& len_param = func->call_parameters[length_i];
 
             if (len_param.direction == GI_DIRECTION_IN) {
-                param.length = GetV8ArrayLength(info[in_arg]);
+                param.length = GetV8ArrayLength(&type_info, info[in_arg]);
 
                 callable_arg_values[length_i].v_long = param.length;
             }
             else if (len_param.direction == GI_DIRECTION_INOUT) {
-                len_param.data.v_long = GetV8ArrayLength(info[in_arg]);
+                len_param.data.v_long = GetV8ArrayLength(&type_info, info[in_arg]);
 
                 callable_arg_values[length_i].v_pointer = &len_param.data;
             }
@@ -220,8 +243,34 @@ Local<Value> FunctionCall (
         }
         else /* (direction == GI_DIRECTION_IN || direction == GI_DIRECTION_INOUT) */ {
 
+            void *view_data;
+            long view_length;
+
             // Callback GIArgument is filled above, for the rest...
-            if (param.type != ParameterType::CALLBACK) {
+            if (param.type == ParameterType::ARRAY
+                    && direction == GI_DIRECTION_IN
+                    && g_arg_info_get_ownership_transfer (&arg_info) == GI_TRANSFER_NOTHING
+                    && g_type_info_get_array_type (&type_info) == GI_ARRAY_TYPE_C
+                    && !g_type_info_is_zero_terminated (&type_info)
+                    && GetArrayBufferViewData (&type_info, info[in_arg], &view_data, &view_length)) {
+
+                /* The memory of the view is passed as is: the view is
+                 * referenced by the call arguments until it returns */
+                callable_arg_values[i].v_pointer = view_data;
+                borrowed_args[i] = true;
+
+            } else if (param.type == ParameterType::NORMAL
+                    && direction == GI_DIRECTION_IN
+                    && g_arg_info_get_ownership_transfer (&arg_info) == GI_TRANSFER_NOTHING
+                    && g_type_info_get_tag (&type_info) == GI_TYPE_TAG_UTF8
+                    && info[in_arg]->IsString()) {
+
+                /* Strings the callee doesn't keep only need to live
+                 * for the call */
+                callable_arg_values[i].v_pointer = scratch.WriteUtf8 (info[in_arg].As<String>());
+                borrowed_args[i] = true;
+
+            } else if (param.type != ParameterType::CALLBACK) {
 
                 // FIXME(handle failure here)
                 FillArgument(&arg_info, &callable_arg_values[i], info[in_arg]);
@@ -302,6 +351,9 @@ Local<Value> FunctionCall (
         GITransfer transfer   = g_arg_info_get_ownership_transfer (&arg_info);
 
         if (param.type == ParameterType::ARRAY) {
+            if (direction == GI_DIRECTION_IN && borrowed_args[i])
+                continue;
+
             if (direction == GI_DIRECTION_INOUT || direction == GI_DIRECTION_OUT)
                 FreeGIArgumentArray (&arg_type, (GIArgument*)arg_value.v_pointer, transfer, direction, param.length);
             else
@@ -316,7 +368,7 @@ Local<Value> FunctionCall (
                 delete callback;
             }
         }
-        else {
+        else if (!(direction == GI_DIRECTION_IN && borrowed_args[i])) {
             if (direction == GI_DIRECTION_INOUT || (direction == GI_DIRECTION_OUT && !g_arg_info_is_caller_allocates (&arg_info)))
                 FreeGIArgument (&arg_type, (GIArgument*)arg_value.v_pointer, transfer, direction);
             else
@@ -535,7 +587,16 @@ Local<Value> FunctionInfo::GetReturnValue (GITypeInfo* return_type, GIArgument*
         int length_i = g_type_info_get_array_length(return_type);
         if (length_i >= 0)
             length = callable_arg_values[length_i].v_long;
-        ADD_RETURN (GIArgumentToV8 (return_type, return_value, length))
+        GITransfer transfer = g_callable_info_get_caller_owns (info);
+        Local<Value> result;
+
+        /* Numeric arrays that are ours are taken over, see ArrayToV8 */
+        if (g_type_info_get_tag (return_type) == GI_TYPE_TAG_ARRAY && transfer == GI_TRANSFER_EVERYTHING)
+            result = ArrayToV8 (return_type, return_value->v_pointer, length, &return_value->v_pointer);
+        else
+            result = GIArgumentToV8 (return_type, return_value, length, transfer);
+
+        ADD_RETURN (result)
     }
 
     for (int i = 0; i < n_callable_args; i++) {
@@ -563,13 +624,22 @@ Local<Value> FunctionInfo::GetReturnValue (GITypeInfo* return_type, GIArgument*
                 else
                     param.length = callable_arg_values[length_i].v_long;
 
-                Local<Value> result = ArrayToV8(&arg_type, *(void**)arg_value.v_pointer, param.length);
+                bool adopt = g_arg_info_get_ownership_transfer (&arg_info) == GI_TRANSFER_EVERYTHING
+                    && !g_arg_info_is_caller_allocates (&arg_info);
+
+                Local<Value> result = ArrayToV8(&arg_type, *(void**)arg_value.v_pointer, param.length,
+                        adopt ? (gpointer *) arg_value.v_pointer : NULL);
 
                 ADD_RETURN (result)
 
             } else if (param.type == ParameterType::NORMAL) {
 
-                ADD_RETURN (GIArgumentToV8(&arg_type, (GIArgument*) arg_value.v_pointer))
+                /* Caller-allocated structs are ours, whatever their transfer */
+                GITransfer transfer = g_arg_info_is_caller_allocates (&arg_info)
+                    ? GI_TRANSFER_EVERYTHING
+                    : g_arg_info_get_ownership_transfer (&arg_info);
+
+                ADD_RETURN (GIArgumentToV8(&arg_type, (GIArgument*) arg_value.v_pointer, -1, transfer))
             }
         }
     }
@@ -3,14 +3,22 @@
 #include <nan.h>
 
 #include "boxed.h"
+#include "bytes.h"
 #include "debug.h"
+#include "field.h"
+#include "finalize.h"
 #include "function.h"
 #include "gi.h"
 #include "gobject.h"
+#include "intern.h"
 #include "loop.h"
+#include "memory.h"
+#include "release.h"
+#include "subclass.h"
 #include "type.h"
 #include "util.h"
 #include "value.h"
+#include "watch.h"
 
 using namespace v8;
 using GNodeJS::BaseInfo;
@@ -20,6 +28,10 @@ namespace GNodeJS {
     G_DEFINE_QUARK(gnode_js_object,      object);
     G_DEFINE_QUARK(gnode_js_template,    template);
     G_DEFINE_QUARK(gnode_js_constructor, constructor);
+    G_DEFINE_QUARK(gnode_js_construction, construction);
+    G_DEFINE_QUARK(gnode_js_listeners, listeners);
+    G_DEFINE_QUARK(gnode_js_signal_query, signal_query);
+    G_DEFINE_QUARK(gnode_js_subclass, subclass);
 
     Nan::Persistent<Object> moduleCache(Nan::New<Object>());
 
@@ -162,7 +174,10 @@ NAN_METHOD(MakeBoxedClass) {
 NAN_METHOD(ObjectPropertyGetter) {
     GObject *gobject = GNodeJS::GObjectFromWrapper (info[0]);
 
-    g_assert(gobject != NULL);
+    if (gobject == NULL) {
+        Nan::ThrowError("ObjectPropertyGetter: instance has been released");
+        return;
+    }
 
     Nan::Utf8String prop_name_v (info[1]->ToString ());
     const char *prop_name = *prop_name_v;
@@ -187,8 +202,8 @@ NAN_METHOD(ObjectPropertySetter) {
     const char *prop_name = *prop_name_v;
 
     if (gobject == NULL) {
-        WARN("ObjectPropertySetter: null GObject; cant get %s", prop_name);
-        RETURN(Nan::False());
+        Nan::ThrowError("ObjectPropertySetter: instance has been released");
+        return;
     }
 
     GParamSpec *pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (gobject), prop_name);
@@ -213,87 +228,148 @@ NAN_METHOD(ObjectPropertySetter) {
     }
 }
 
-NAN_METHOD(StructFieldSetter) {
-    Local<Object> boxedWrapper = info[0].As<Object>();
-    Local<Object> fieldInfo    = info[1].As<Object>();
-    Local<Value>  value        = info[2];
+NAN_METHOD(Watch) {
+    if (!info[0]->IsFunction()) {
+        Nan::ThrowTypeError("Watch: callback is not a function");
+        return;
+    }
 
-    void        *boxed = GNodeJS::BoxedFromWrapper(boxedWrapper);
-    GIFieldInfo *field = (GIFieldInfo *) GNodeJS::BoxedFromWrapper(fieldInfo);
-    GITypeInfo  *field_type = g_field_info_get_type(field);
+    guint interval = info[1]->IsNumber() ? info[1]->Uint32Value() : 0;
 
-    g_assert(boxed);
-    g_assert(field);
-    g_assert(field_type);
+    RETURN(GNodeJS::Watcher::New(info[0].As<Function>(), interval));
+}
 
-    GIArgument arg;
+NAN_METHOD(RegisterExternalSize) {
+    if (!info[0]->IsString()) {
+        Nan::ThrowTypeError("RegisterExternalSize: type name is not a string");
+        return;
+    }
 
-    if (!GNodeJS::V8ToGIArgument(field_type, &arg, value, true)) {
-        char *message = g_strdup_printf("Couldn't convert value for field '%s'",
-                g_base_info_get_name(field));
-        Nan::ThrowTypeError (message);
-        g_free(message);
+    if (!info[1]->IsFunction()) {
+        Nan::ThrowTypeError("RegisterExternalSize: hook is not a function");
+        return;
+    }
 
-        RETURN (Nan::Undefined());
+    Nan::Utf8String type_name (info[0]);
+    GNodeJS::RegisterExternalSize (*type_name, info[1].As<Function>());
+}
 
-    } else {
+NAN_METHOD(UnregisterExternalSize) {
+    if (!info[0]->IsString()) {
+        Nan::ThrowTypeError("UnregisterExternalSize: type name is not a string");
+        return;
+    }
 
-        if (g_field_info_set_field(field, boxed, &arg) == FALSE) {
-            Nan::ThrowError("Unable to set field (complex types not allowed)");
-            RETURN (Nan::Undefined());
-        }
-
-        /*
-         * g_field_info_set_field:
-         *   This only handles fields of simple C types. It will fail for a field of
-         *   a composite type like a nested structure or union even if that is actually
-         *   writable. Note also that that it will refuse to write fields where memory
-         *   management would by required. A field with a type such as 'char *' must be
-         *   set with a setter function.
-         * Therefore, no need to free GIArgument.
-         */
+    Nan::Utf8String type_name (info[0]);
+    GNodeJS::UnregisterExternalSize (*type_name);
+}
+
+NAN_METHOD(RegisterClass) {
+    if (!info[0]->IsString() || !info[1]->IsNumber() || !info[2]->IsArray() || !info[3]->IsFunction()) {
+        Nan::ThrowTypeError("RegisterClass: invalid arguments");
+        return;
+    }
 
+    Nan::Utf8String name (info[0]);
+    GType parent = (GType) info[1]->NumberValue();
+    Local<Array> interfaces_array = info[2].As<Array>();
+
+    GArray *interfaces = g_array_sized_new (FALSE, FALSE, sizeof (GType), interfaces_array->Length());
+    for (uint32_t i = 0; i < interfaces_array->Length(); i++) {
+        GType interface = (GType) Nan::Get(interfaces_array, i).ToLocalChecked()->NumberValue();
+        g_array_append_val (interfaces, interface);
     }
 
-    g_base_info_unref (field_type);
+    GType gtype = GNodeJS::RegisterClass (*name, parent, interfaces, info[3].As<Function>());
+
+    g_array_free (interfaces, TRUE);
+
+    if (gtype != G_TYPE_INVALID)
+        RETURN(Nan::New<Number>(gtype));
 }
 
-NAN_METHOD(StructFieldGetter) {
-    Local<Object> boxedWrapper = info[0].As<Object>();
-    Local<Object> fieldInfo    = info[1].As<Object>();
+NAN_METHOD(PushReleaseScope) {
+    GNodeJS::PushReleaseScope ();
+}
 
-    if (boxedWrapper->InternalFieldCount() == 0) {
-        Nan::ThrowError("StructFieldGetter: instance is not a boxed");
+NAN_METHOD(PopReleaseScope) {
+    GNodeJS::PopReleaseScope (info[0]);
+}
+
+NAN_METHOD(GetStructBuffer) {
+    if (!info[0]->IsObject()) {
+        Nan::ThrowTypeError("GetStructBuffer: argument is not a struct or union");
         return;
     }
 
-    if (fieldInfo->InternalFieldCount() == 0) {
-        Nan::ThrowError("StructFieldGetter: field info is invalid");
+    Local<Value> buffer = GNodeJS::GetStructBuffer(info[0].As<Object>());
+
+    if (!buffer.IsEmpty())
+        RETURN(buffer);
+}
+
+NAN_METHOD(KeepBoxed) {
+    if (!info[0]->IsObject() || info[0].As<Object>()->InternalFieldCount() < 2) {
+        Nan::ThrowTypeError("KeepBoxed: argument is not a struct or union");
         return;
     }
 
-    void        *boxed = GNodeJS::BoxedFromWrapper(boxedWrapper);
-    GIFieldInfo *field = (GIFieldInfo *) GNodeJS::BoxedFromWrapper(fieldInfo);
+    if (GNodeJS::EnsureOwnedBoxed (info[0].As<Object>()) == NULL) {
+        Nan::ThrowError("KeepBoxed: instance has been released or can't be copied");
+        return;
+    }
 
-    if (boxed == NULL) {
-        Nan::ThrowError("StructFieldGetter: instance is NULL");
+    RETURN(info[0]);
+}
+
+NAN_METHOD(BytesToBuffer) {
+    if (!GNodeJS::ValueIsInstanceOfGType (info[0], G_TYPE_BYTES)) {
+        Nan::ThrowTypeError("BytesToBuffer: argument is not a GLib.Bytes");
         return;
     }
 
-    if (field == NULL) {
-        Nan::ThrowError("StructFieldGetter: field info is NULL");
+    GBytes *bytes = (GBytes *) GNodeJS::BoxedFromWrapper (info[0]);
+
+    if (bytes == NULL) {
+        Nan::ThrowError("BytesToBuffer: instance has been released");
         return;
     }
 
-    GIArgument value;
-    if (!g_field_info_get_field(field, boxed, &value)) {
-        Nan::ThrowError("Unable to get field (complex types not allowed)");
+    RETURN(GNodeJS::BufferFromBytes (bytes));
+}
+
+NAN_METHOD(BufferToBytes) {
+    if (!info[0]->IsArrayBufferView()) {
+        Nan::ThrowTypeError("BufferToBytes: argument is not a Buffer or typed array");
         return;
     }
 
-    GITypeInfo  *field_type = g_field_info_get_type(field);
-    RETURN(GNodeJS::GIArgumentToV8(field_type, &value));
-    g_base_info_unref (field_type);
+    GIBaseInfo *bytes_info = g_irepository_find_by_gtype (NULL, G_TYPE_BYTES);
+
+    if (bytes_info == NULL) {
+        Nan::ThrowError("BufferToBytes: GLib typelib is not loaded");
+        return;
+    }
+
+    GBytes *bytes = GNodeJS::BytesFromBuffer (info[0].As<Object>());
+    RETURN(GNodeJS::WrapperFromBoxed (bytes_info, bytes));
+
+    g_base_info_unref (bytes_info);
+}
+
+NAN_METHOD(GetStructLayout) {
+    GIBaseInfo *gi_info = (GIBaseInfo *) GNodeJS::BoxedFromWrapper (info[0]);
+    RETURN(GNodeJS::GetStructLayout (gi_info));
+}
+
+NAN_METHOD(SetColumnarStructs) {
+    bool previous = GNodeJS::SetColumnarStructs (info[0]->BooleanValue ());
+    RETURN(Nan::New<v8::Boolean>(previous));
+}
+
+NAN_METHOD(SetHashAsMap) {
+    bool previous = GNodeJS::SetHashAsMap (info[0]->BooleanValue ());
+    RETURN(Nan::New<v8::Boolean>(previous));
 }
 
 NAN_METHOD(StartLoop) {
@@ -317,6 +393,54 @@ NAN_METHOD(GetTypeSize) {
     info.GetReturnValue().Set(Nan::New<Number>(size));
 }
 
+static Local<Object> MakeSlabStats(guint32 live, guint32 capacity) {
+    Local<Object> stats = Nan::New<Object>();
+    Nan::Set(stats, UTF8("live"), Nan::New<Number>(live));
+    Nan::Set(stats, UTF8("capacity"), Nan::New<Number>(capacity));
+    return stats;
+}
+
+NAN_METHOD(GetStats) {
+    guint32 live, capacity;
+    Local<Object> stats = Nan::New<Object>();
+    Local<Object> wrappers = Nan::New<Object>();
+
+    GNodeJS::GetGObjectWrapperStats (&live, &capacity);
+    Nan::Set(wrappers, UTF8("objects"), MakeSlabStats(live, capacity));
+
+    GNodeJS::GetBoxedWrapperStats (&live, &capacity);
+    Nan::Set(wrappers, UTF8("boxed"), MakeSlabStats(live, capacity));
+
+    Nan::Set(stats, UTF8("wrappers"), wrappers);
+
+    GNodeJS::FinalizationStats finalization_stats;
+    GNodeJS::GetFinalizationStats (&finalization_stats);
+
+    Local<Object> finalization = Nan::New<Object>();
+    Nan::Set(finalization, UTF8("pending"), Nan::New<Number>(finalization_stats.pending));
+    Nan::Set(finalization, UTF8("maxPending"), Nan::New<Number>(finalization_stats.max_pending));
+    Nan::Set(finalization, UTF8("finalized"), Nan::New<Number>((double) finalization_stats.finalized));
+    Nan::Set(finalization, UTF8("lastSliceTime"), Nan::New<Number>(finalization_stats.last_slice_us / 1000.0));
+    Nan::Set(finalization, UTF8("maxSliceTime"), Nan::New<Number>(finalization_stats.max_slice_us / 1000.0));
+    Nan::Set(stats, UTF8("finalization"), finalization);
+
+    Nan::Set(stats, UTF8("toggles"), GNodeJS::GetToggleStats());
+
+    GNodeJS::InternStats intern_stats;
+    GNodeJS::GetInternStringStats (&intern_stats);
+
+    Local<Object> strings = Nan::New<Object>();
+    guint64 lookups = intern_stats.hits + intern_stats.misses;
+    Nan::Set(strings, UTF8("hits"), Nan::New<Number>((double) intern_stats.hits));
+    Nan::Set(strings, UTF8("misses"), Nan::New<Number>((double) intern_stats.misses));
+    Nan::Set(strings, UTF8("hitRate"), Nan::New<Number>(lookups ? (double) intern_stats.hits / lookups : 0));
+    Nan::Set(strings, UTF8("entries"), Nan::New<Number>(intern_stats.entries));
+    Nan::Set(strings, UTF8("capacity"), Nan::New<Number>(intern_stats.capacity));
+    Nan::Set(stats, UTF8("strings"), strings);
+
+    RETURN(stats);
+}
+
 NAN_METHOD(GetLoopStack) {
     auto stack = GNodeJS::GetLoopStack();
     info.GetReturnValue().Set(stack);
@@ -334,15 +458,27 @@ void InitModule(Local<Object> exports, Local<Value> module, void *priv) {
     NAN_EXPORT(exports, MakeObjectClass);
     NAN_EXPORT(exports, MakeFunction);
     NAN_EXPORT(exports, MakeVirtualFunction);
-    NAN_EXPORT(exports, StructFieldGetter);
-    NAN_EXPORT(exports, StructFieldSetter);
     NAN_EXPORT(exports, ObjectPropertyGetter);
     NAN_EXPORT(exports, ObjectPropertySetter);
+    NAN_EXPORT(exports, Watch);
+    NAN_EXPORT(exports, RegisterExternalSize);
+    NAN_EXPORT(exports, UnregisterExternalSize);
+    NAN_EXPORT(exports, RegisterClass);
+    NAN_EXPORT(exports, PushReleaseScope);
+    NAN_EXPORT(exports, PopReleaseScope);
+    NAN_EXPORT(exports, GetStructBuffer);
+    NAN_EXPORT(exports, GetStructLayout);
+    NAN_EXPORT(exports, SetColumnarStructs);
+    NAN_EXPORT(exports, SetHashAsMap);
+    NAN_EXPORT(exports, KeepBoxed);
+    NAN_EXPORT(exports, BytesToBuffer);
+    NAN_EXPORT(exports, BufferToBytes);
     NAN_EXPORT(exports, StartLoop);
     NAN_EXPORT(exports, InternalFieldCount);
     NAN_EXPORT(exports, GetBaseClass);
     NAN_EXPORT(exports, GetTypeSize);
     NAN_EXPORT(exports, GetLoopStack);
+    NAN_EXPORT(exports, GetStats);
 }
 
 NODE_MODULE(node_gtk, InitModule)
@@ -36,6 +36,10 @@ Local<Object> GetModuleCache();
 GQuark object_quark (void);
 GQuark template_quark (void);
 GQuark constructor_quark (void);
+GQuark construction_quark (void);
+GQuark listeners_quark (void);
+GQuark signal_query_quark (void);
+GQuark subclass_quark (void);
 
 
 /*
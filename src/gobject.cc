@@ -4,10 +4,15 @@
 #include "boxed.h"
 #include "closure.h"
 #include "debug.h"
+#include "finalize.h"
 #include "function.h"
 #include "gi.h"
 #include "gobject.h"
 #include "macros.h"
+#include "memory.h"
+#include "release.h"
+#include "slab.h"
+#include "subclass.h"
 #include "type.h"
 #include "util.h"
 #include "value.h"
@@ -33,78 +38,304 @@ static Nan::Persistent<FunctionTemplate> baseTemplate;
 
 static void GObjectDestroyed(const v8::WeakCallbackInfo<GObject> &data);
 
+/*
+ * Wrapper records. The object_quark qdata of a wrapped GObject holds the
+ * handle of its record in the slab.
+ */
+
+struct ObjectRecord {
+    Persistent<Object> persistent;
+    GObject *gobject;
+    size_t external_size; // reported to V8 as external memory
+    bool weak;            // the persistent is weak
+    bool weak_pending;    // the persistent will be made weak at the next GC
+    bool queued;          // the record is in pendingWeakRecords
+};
+
+static Slab<ObjectRecord> objectRecords;
+
+/* Handles of the records that toggled down since the last GC */
+static GArray *pendingWeakRecords = NULL;
+
+static ObjectRecord *GetObjectRecord (GObject *gobject) {
+    guint32 handle = GPOINTER_TO_UINT (g_object_get_qdata (gobject, GNodeJS::object_quark()));
+    return handle != 0 ? objectRecords.Get (handle) : NULL;
+}
+
+/**
+ * Forgets the wrapper of @gobject, without dropping the references it holds
+ */
+static void FreeObjectRecord (GObject *gobject) {
+    guint32 handle = GPOINTER_TO_UINT (g_object_steal_qdata (gobject, GNodeJS::object_quark()));
+    ObjectRecord *record = objectRecords.Get (handle);
+
+    if (record->queued) {
+        for (guint i = 0; i < pendingWeakRecords->len; i++) {
+            if (g_array_index (pendingWeakRecords, guint32, i) == handle) {
+                g_array_remove_index_fast (pendingWeakRecords, i);
+                break;
+            }
+        }
+    }
+
+    record->persistent.Reset ();
+    AdjustExternalSize (-(int64_t) record->external_size);
+
+    objectRecords.Free (handle);
+}
+
+/*
+ * Toggle counters, per GType
+ */
+
+struct ToggleCounters {
+    guint64 toggles;      // toggle notifications
+    guint64 weakened;     // persistents made weak
+    guint64 strengthened; // persistents made strong again
+};
+
+static GHashTable *toggleCounters = NULL; // GType => ToggleCounters*
+
+static ToggleCounters *GetToggleCounters (GType gtype) {
+    if (toggleCounters == NULL)
+        toggleCounters = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+
+    auto *counters = (ToggleCounters *) g_hash_table_lookup (toggleCounters, GSIZE_TO_POINTER (gtype));
+
+    if (counters == NULL) {
+        counters = g_new0 (ToggleCounters, 1);
+        g_hash_table_insert (toggleCounters, GSIZE_TO_POINTER (gtype), counters);
+    }
+
+    return counters;
+}
+
 static Local<FunctionTemplate> GetClassTemplateFromGI(GIBaseInfo *info);
+static GParamSpec* FindClassProperty(GObjectClass *klass, const char *name);
+
+/*
+ * Construction cache. For each GType, the class stays referenced and the
+ * property specs resolved for the last few lists of option keys ("shapes")
+ * used with `new Type({ ... })` are kept, so constructing many objects with
+ * the same options doesn't resolve every property by name again.
+ */
+
+#define MAX_CONSTRUCTION_SHAPES 8
+
+struct ConstructionShape {
+    uint32_t n_keys;
+    Nan::Persistent<Value> *keys; // as returned by GetOwnPropertyNames()
+    GParamSpec **pspecs; // NULL for keys that are not properties (ignored)
+
+    ~ConstructionShape() {
+        for (uint32_t i = 0; i < n_keys; i++)
+            keys[i].Reset ();
+        delete[] keys;
+        g_free (pspecs);
+    }
+};
 
-static bool InitGParameterFromProperty(GParameter    *parameter,
-                                       void          *klass,
-                                       Local<String>  name,
-                                       Local<Value>   value) {
-    Nan::Utf8String name_utf8 (name);
-    GParamSpec *pspec = g_object_class_find_property (G_OBJECT_CLASS (klass), *name_utf8);
+struct ConstructionCache {
+    GObjectClass *klass;
+    GPtrArray    *shapes; // ConstructionShape*, most recently created first
+};
 
-    // Ignore additionnal keys in options, thus return true
-    if (pspec == NULL)
-        return true;
+static ConstructionCache* GetConstructionCache(GType gtype) {
+    auto *cache = (ConstructionCache *) g_type_get_qdata (gtype, GNodeJS::construction_quark());
 
-    GType value_type = G_PARAM_SPEC_VALUE_TYPE (pspec);
-    parameter->name = pspec->name;
-    g_value_init (&parameter->value, value_type);
+    if (cache == NULL) {
+        cache = g_new0 (ConstructionCache, 1);
+        cache->klass = G_OBJECT_CLASS (g_type_class_ref (gtype)); // never unref'd
+        cache->shapes = g_ptr_array_new ();
+        g_type_set_qdata (gtype, GNodeJS::construction_quark(), cache);
+    }
 
-    if (!CanConvertV8ToGValue(&parameter->value, value)) {
-        char* message = g_strdup_printf("Cannot convert value for property \"%s\", expected type %s",
-                *name_utf8, g_type_name(value_type));
-        Nan::ThrowTypeError(message);
-        free(message);
-        return false;
+    return cache;
+}
+
+static ConstructionShape* FindConstructionShape(ConstructionCache *cache, Local<Array> keys) {
+    uint32_t n_keys = keys->Length ();
+
+    for (guint i = 0; i < cache->shapes->len; i++) {
+        auto *shape = (ConstructionShape *) g_ptr_array_index (cache->shapes, i);
+
+        if (shape->n_keys != n_keys)
+            continue;
+
+        bool matches = true;
+        for (uint32_t j = 0; j < n_keys && matches; j++)
+            matches = Nan::New (shape->keys[j])->StrictEquals (Nan::Get (keys, j).ToLocalChecked ());
+
+        if (matches)
+            return shape;
     }
 
-    if (!V8ToGValue (&parameter->value, value)) {
-        char* message = g_strdup_printf("Couldn't convert value for property \"%s\", expected type %s",
-                *name_utf8, g_type_name(value_type));
-        Nan::ThrowTypeError(message);
-        free(message);
-        return false;
+    return NULL;
+}
+
+static ConstructionShape* NewConstructionShape(ConstructionCache *cache, Local<Array> keys) {
+    auto *shape = new ConstructionShape();
+    shape->n_keys = keys->Length ();
+    shape->keys = new Nan::Persistent<Value>[shape->n_keys];
+    shape->pspecs = g_new0 (GParamSpec *, shape->n_keys);
+
+    for (uint32_t i = 0; i < shape->n_keys; i++) {
+        Local<Value> name = Nan::Get (keys, i).ToLocalChecked ();
+        Nan::Utf8String name_utf8 (name);
+
+        shape->keys[i].Reset (name);
+        // Ignore additionnal keys in options, thus NULL is fine
+        shape->pspecs[i] = FindClassProperty (cache->klass, *name_utf8);
+    }
+
+    if (cache->shapes->len >= MAX_CONSTRUCTION_SHAPES) {
+        auto *oldest = (ConstructionShape *) g_ptr_array_index (cache->shapes, cache->shapes->len - 1);
+        g_ptr_array_remove_index (cache->shapes, cache->shapes->len - 1);
+        delete oldest;
+    }
+
+    g_ptr_array_insert (cache->shapes, 0, shape);
+
+    return shape;
+}
+
+/**
+ * Creates a new GObject, with the properties in @property_hash
+ * @returns the new object, or NULL if a JS exception has been thrown
+ */
+static GObject* NewGObjectFromProperties(GType gtype, Local<Object> property_hash) {
+    ConstructionCache *cache = GetConstructionCache (gtype);
+    Local<Array> keys = property_hash->GetOwnPropertyNames ();
+
+    ConstructionShape *shape = FindConstructionShape (cache, keys);
+    if (shape == NULL)
+        shape = NewConstructionShape (cache, keys);
+
+    GObject *gobject = NULL;
+    const char **names = g_new0 (const char *, shape->n_keys);
+    GValue *values = g_new0 (GValue, shape->n_keys);
+    guint n_properties = 0;
+
+    for (uint32_t i = 0; i < shape->n_keys; i++) {
+        GParamSpec *pspec = shape->pspecs[i];
+
+        if (pspec == NULL)
+            continue;
+
+        Local<Value> value = Nan::Get (property_hash, Nan::New (shape->keys[i])).ToLocalChecked ();
+        GValue *gvalue = &values[n_properties];
+        g_value_init (gvalue, G_PARAM_SPEC_VALUE_TYPE (pspec));
+
+        if (!CanConvertV8ToGValue (gvalue, value)) {
+            Nan::Utf8String name_utf8 (Nan::New (shape->keys[i]));
+            char* message = g_strdup_printf("Cannot convert value for property \"%s\", expected type %s",
+                    *name_utf8, g_type_name(G_VALUE_TYPE (gvalue)));
+            Nan::ThrowTypeError(message);
+            g_free(message);
+            g_value_unset (gvalue);
+            goto out;
+        }
+
+        if (!V8ToGValue (gvalue, value)) {
+            Nan::Utf8String name_utf8 (Nan::New (shape->keys[i]));
+            char* message = g_strdup_printf("Couldn't convert value for property \"%s\", expected type %s",
+                    *name_utf8, g_type_name(G_VALUE_TYPE (gvalue)));
+            Nan::ThrowTypeError(message);
+            g_free(message);
+            g_value_unset (gvalue);
+            goto out;
+        }
+
+        names[n_properties] = pspec->name;
+        n_properties++;
+    }
+
+#if GLIB_CHECK_VERSION(2, 54, 0)
+    gobject = g_object_new_with_properties (gtype, n_properties, names, values);
+#else
+    {
+        GParameter *parameters = g_new0 (GParameter, n_properties);
+        for (guint i = 0; i < n_properties; i++) {
+            parameters[i].name = names[i];
+            parameters[i].value = values[i];
+        }
+        gobject = (GObject *) g_object_newv (gtype, n_properties, parameters);
+        g_free (parameters);
     }
+#endif
 
-    return true;
+out:
+    for (guint i = 0; i < n_properties; i++)
+        g_value_unset (&values[i]);
+
+    g_free (names);
+    g_free (values);
+
+    return gobject;
 }
 
-static bool InitGParametersFromProperty(GParameter    **parameters_p,
-                                        int            *n_parameters_p,
-                                        void           *klass,
-                                        Local<Object>  property_hash) {
-    Local<Array> properties = property_hash->GetOwnPropertyNames ();
-    int n_parameters = properties->Length ();
-    GParameter *parameters = g_new0 (GParameter, n_parameters);
+/**
+ * Makes the persistents of the records that toggled down weak. Called
+ * before each GC, so that objects toggling many times between two GCs
+ * (e.g. transiently referenced by GLib internals) don't change the
+ * weakness of their persistent each time.
+ */
+static void ApplyPendingWeak (Isolate *isolate, v8::GCType type, v8::GCCallbackFlags flags) {
+    for (guint i = 0; i < pendingWeakRecords->len; i++) {
+        ObjectRecord *record = objectRecords.Get (g_array_index (pendingWeakRecords, guint32, i));
+
+        record->queued = false;
 
-    for (int i = 0; i < n_parameters; i++) {
-        Local<String> name = properties->Get(i)->ToString();
-        Local<Value> value = property_hash->Get (name);
+        /* It toggled up again since */
+        if (!record->weak_pending)
+            continue;
 
-        if (!InitGParameterFromProperty (&parameters[i], klass, name->ToString (), value))
-            return false;
+        record->weak_pending = false;
+        record->weak = true;
+        record->persistent.SetWeak (record->gobject, GObjectDestroyed, v8::WeakCallbackType::kParameter);
+
+        GetToggleCounters (G_OBJECT_TYPE (record->gobject))->weakened++;
     }
 
-    *parameters_p = parameters;
-    *n_parameters_p = n_parameters;
-    return true;
+    g_array_set_size (pendingWeakRecords, 0);
 }
 
 static void ToggleNotify(gpointer user_data, GObject *gobject, gboolean toggle_down) {
-    void *data = g_object_get_qdata (gobject, GNodeJS::object_quark());
+    guint32 handle = GPOINTER_TO_UINT (g_object_get_qdata (gobject, GNodeJS::object_quark()));
 
-    g_assert (data != NULL);
+    /* The wrapper has been released */
+    if (handle == 0)
+        return;
 
-    auto *persistent = (Persistent<Object> *) data;
+    ObjectRecord *record = objectRecords.Get (handle);
+    ToggleCounters *counters = GetToggleCounters (G_OBJECT_TYPE (gobject));
+    counters->toggles++;
 
     if (toggle_down) {
         /* We're dropping from 2 refs to 1 ref. We are the last holder. Make
-         * sure that that our weak ref is installed. */
-        persistent->SetWeak (gobject, GObjectDestroyed, v8::WeakCallbackType::kParameter);
+         * sure that that our weak ref is installed before the next GC. */
+        record->weak_pending = true;
+
+        if (!record->queued) {
+            if (pendingWeakRecords == NULL) {
+                pendingWeakRecords = g_array_new (FALSE, FALSE, sizeof (guint32));
+                Nan::AddGCPrologueCallback (ApplyPendingWeak);
+            }
+
+            record->queued = true;
+            g_array_append_val (pendingWeakRecords, handle);
+        }
     } else {
         /* We're going from 1 ref to 2 refs. We can't let our wrapper be
-         * collected, so make sure that our reference is persistent */
-        persistent->ClearWeak ();
+         * collected, so make sure that our reference is persistent. If no
+         * GC happened since the object toggled down, it still is. */
+        if (record->weak_pending) {
+            record->weak_pending = false;
+        } else if (record->weak) {
+            record->weak = false;
+            record->persistent.ClearWeak ();
+            counters->strengthened++;
+        }
     }
 }
 
@@ -114,8 +345,23 @@ static void AssociateGObject(Isolate *isolate, Local<Object> object, GObject *go
     g_object_ref_sink (gobject);
     g_object_add_toggle_ref (gobject, ToggleNotify, NULL);
 
-    Persistent<Object> *persistent = new Persistent<Object>(isolate, object);
-    g_object_set_qdata (gobject, GNodeJS::object_quark(), persistent);
+    guint32 handle = objectRecords.Alloc ();
+    ObjectRecord *record = objectRecords.Get (handle);
+    record->persistent.Reset (isolate, object);
+    record->gobject = gobject;
+    record->external_size = 0;
+    record->weak = false;
+    record->weak_pending = false;
+    record->queued = false;
+    g_object_set_qdata (gobject, GNodeJS::object_quark(), GUINT_TO_POINTER (handle));
+
+    size_t external_size = 0;
+    if (GetExternalSize (G_OBJECT_TYPE (gobject), gobject, object, &external_size) && external_size > 0) {
+        record->external_size = external_size;
+        AdjustExternalSize (external_size);
+    }
+
+    TrackWrapper (object, WRAPPER_GOBJECT);
 }
 
 static void GObjectConstructor(const FunctionCallbackInfo<Value> &info) {
@@ -140,58 +386,75 @@ static void GObjectConstructor(const FunctionCallbackInfo<Value> &info) {
         void *data = External::Cast (*info[0])->Value ();
         GObject *gobject = G_OBJECT (data);
         AssociateGObject (isolate, self, gobject);
-
-        Nan::DefineOwnProperty(self,
-                Nan::New<String>("__gtype__").ToLocalChecked(),
-                Nan::New<Number>(G_OBJECT_TYPE(gobject)),
-                (v8::PropertyAttribute)(v8::PropertyAttribute::ReadOnly | v8::PropertyAttribute::DontEnum)
-        );
     } else {
         /* User code calling `new Gtk.Widget({ ... })` */
 
         GObject *gobject;
         GIBaseInfo *gi_info = (GIBaseInfo *) External::Cast (*info.Data ())->Value ();
         GType gtype = g_registered_type_info_get_g_type ((GIRegisteredTypeInfo *) gi_info);
-        void *klass = g_type_class_ref (gtype);
+        GType template_gtype = gtype;
 
-        GParameter *parameters = NULL;
-        int n_parameters = 0;
+        /* JS classes extending this one may have registered their own
+         * type (see subclass.cc), which they expose as `gtype` */
+        Local<Value> new_target = info.NewTarget ();
+        if (new_target->IsFunction ()) {
+            Local<Value> target_gtype = Nan::Get (new_target.As<Object> (), UTF8("gtype")).ToLocalChecked ();
+
+            if (target_gtype->IsNumber () && g_type_is_a ((GType) target_gtype->NumberValue (), gtype))
+                gtype = (GType) target_gtype->NumberValue ();
+        }
 
         if (info[0]->IsObject ()) {
-            Local<Object> property_hash = info[0]->ToObject ();
+            gobject = NewGObjectFromProperties (gtype, info[0]->ToObject ());
 
-            if (!InitGParametersFromProperty (&parameters, &n_parameters, klass, property_hash)) {
-                // Error will already be thrown from InitGParametersFromProperty
-                goto out;
+            if (gobject == NULL) {
+                // Error will already be thrown from NewGObjectFromProperties
+                return;
             }
+        } else {
+            gobject = (GObject *) g_object_new (gtype, NULL);
         }
 
-        gobject = (GObject *) g_object_newv (gtype, n_parameters, parameters);
         AssociateGObject (isolate, self, gobject);
 
-        Nan::DefineOwnProperty(self,
-                UTF8("__gtype__"),
-                Nan::New<Number>(gtype),
-                (v8::PropertyAttribute)(v8::PropertyAttribute::ReadOnly | v8::PropertyAttribute::DontEnum)
-        );
-
-    out:
-        g_free (parameters);
-        g_type_class_unref (klass);
+        if (gtype != template_gtype) {
+            Nan::DefineOwnProperty(self,
+                    UTF8("__gtype__"),
+                    Nan::New<Number>(gtype),
+                    (v8::PropertyAttribute)(v8::PropertyAttribute::ReadOnly | v8::PropertyAttribute::DontEnum));
+        }
     }
 }
 
 static void GObjectDestroyed(const v8::WeakCallbackInfo<GObject> &data) {
     GObject *gobject = data.GetParameter ();
 
-    void *type_data = g_object_get_qdata (gobject, GNodeJS::object_quark());
-    Persistent<Object> *persistent = (Persistent<Object> *) type_data;
-    delete persistent;
-
     /* We're destroying the wrapper object, so make sure to clear out
      * the qdata that points back to us. */
-    g_object_set_qdata (gobject, GNodeJS::object_quark(), NULL);
+    FreeObjectRecord (gobject);
 
+    /* The last unref may run a long dispose chain: it is deferred out of
+     * the GC pause, see finalize.cc */
+    QueueObjectUnref (gobject);
+}
+
+/**
+ * Drops the references held by @wrapper now, rather than when it is
+ * garbage collected. The wrapper is left pointing to NULL, so later
+ * uses throw instead of accessing freed memory.
+ */
+void ReleaseGObject(Local<Object> wrapper) {
+    GObject *gobject = GObjectFromWrapper (wrapper);
+
+    if (gobject == NULL)
+        return;
+
+    wrapper->SetAlignedPointerInInternalField (0, NULL);
+
+    FreeObjectRecord (gobject);
+
+    /* Same references as dropped in GObjectDestroyed, plus the toggle ref */
+    g_object_remove_toggle_ref (gobject, ToggleNotify, NULL);
     g_object_unref (gobject);
 }
 
@@ -240,42 +503,48 @@ static void ThrowSignalNotFound(GIBaseInfo *object_info, const char* signal_name
     g_free(message);
 }
 
-static void SignalConnectInternal(const Nan::FunctionCallbackInfo<v8::Value> &info, bool after) {
+/**
+ * Connects info[1] to the signal info[0] of info.This()
+ * @returns the connected closure, or NULL if an exception has been thrown
+ */
+static Closure* SignalConnectInternal(const Nan::FunctionCallbackInfo<v8::Value> &info, bool after) {
     GObject *gobject = GObjectFromWrapper (info.This ());
 
     if (!gobject) {
         Nan::ThrowTypeError("Object is not a GObject");
-        return;
+        return NULL;
     }
 
     if (!info[0]->IsString()) {
         Nan::ThrowTypeError("Signal ID invalid");
-        return;
+        return NULL;
     }
 
     if (!info[1]->IsFunction()) {
         Nan::ThrowTypeError("Signal callback is not a function");
-        return;
+        return NULL;
     }
 
-    const char *signal_name = *Nan::Utf8String (info[0]->ToString());
+    Nan::Utf8String signal_name (info[0]->ToString());
     Local<Function> callback = info[1].As<Function>();
     GType gtype = (GType) Nan::Get(info.This(), UTF8("__gtype__")).ToLocalChecked()->NumberValue();
 
     GIBaseInfo *object_info = g_irepository_find_by_gtype (NULL, gtype);
-    GISignalInfo *signal_info = FindSignalInfo (object_info, signal_name);
+    GISignalInfo *signal_info = FindSignalInfo (object_info, *signal_name);
+    Closure *closure = NULL;
 
     if (signal_info == NULL) {
-        ThrowSignalNotFound(object_info, signal_name);
+        ThrowSignalNotFound(object_info, *signal_name);
     }
     else {
         GClosure *gclosure = MakeClosure (callback, signal_info);
-        ulong handler_id = g_signal_connect_closure (gobject, signal_name, gclosure, after);
-
-        info.GetReturnValue().Set((double)handler_id);
+        closure = (Closure *) gclosure;
+        closure->handler_id = g_signal_connect_closure (gobject, *signal_name, gclosure, after);
     }
 
     g_base_info_unref(object_info);
+
+    return closure;
 }
 
 static void SignalDisconnectInternal(const Nan::FunctionCallbackInfo<v8::Value> &info) {
@@ -298,14 +567,397 @@ static void SignalDisconnectInternal(const Nan::FunctionCallbackInfo<v8::Value>
     info.GetReturnValue().Set((double)handler_id);
 }
 
+static void SignalListenInternal(const Nan::FunctionCallbackInfo<v8::Value> &info, bool once) {
+    Closure *closure = SignalConnectInternal(info, false);
+
+    if (closure == NULL)
+        return;
+
+    closure->event = g_strdup (*Nan::Utf8String (info[0]));
+    closure->once = once;
+    AddListener (GObjectFromWrapper (info.This ()), closure);
+
+    info.GetReturnValue().Set(info.This());
+}
+
 NAN_METHOD(SignalConnect) {
-    SignalConnectInternal(info, false);
+    Closure *closure = SignalConnectInternal(info, false);
+
+    if (closure != NULL)
+        info.GetReturnValue().Set((double)closure->handler_id);
 }
 
 NAN_METHOD(SignalDisconnect) {
     SignalDisconnectInternal(info);
 }
 
+/**
+ * Connects a listener, EventEmitter style
+ * @param event the signal name, with an optional detail
+ * @param callback
+ */
+NAN_METHOD(SignalOn) {
+    SignalListenInternal(info, false);
+}
+
+/**
+ * Connects a listener that is disconnected after its first call
+ * @param event the signal name, with an optional detail
+ * @param callback
+ */
+NAN_METHOD(SignalOnce) {
+    SignalListenInternal(info, true);
+}
+
+/**
+ * Disconnects a listener added with .on() or .once()
+ * @param event the signal name, with an optional detail
+ * @param callback
+ */
+NAN_METHOD(SignalOff) {
+    GObject *gobject = GObjectFromWrapper (info.This ());
+
+    if (!gobject) {
+        Nan::ThrowTypeError("Object is not a GObject");
+        return;
+    }
+
+    if (!info[1]->IsFunction()) {
+        Nan::ThrowTypeError("Signal callback is not a function");
+        return;
+    }
+
+    Nan::Utf8String event (info[0]);
+    Closure *closure = FindListener (gobject, *event, info[1].As<Function>());
+
+    // Removes the closure from the listeners, see Closure::Invalidated
+    if (closure != NULL)
+        g_signal_handler_disconnect (gobject, closure->handler_id);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+/**
+ * Disconnects all the listeners added with .on() or .once()
+ * @param event (optional) disconnect only the listeners of this event
+ */
+NAN_METHOD(SignalRemoveAllListeners) {
+    GObject *gobject = GObjectFromWrapper (info.This ());
+
+    if (!gobject) {
+        Nan::ThrowTypeError("Object is not a GObject");
+        return;
+    }
+
+    GPtrArray *listeners = GetListeners (gobject);
+
+    if (listeners == NULL || listeners->len == 0) {
+        info.GetReturnValue().Set(info.This());
+        return;
+    }
+
+    char *event = info[0]->IsString() ? g_strdup (*Nan::Utf8String (info[0])) : NULL;
+
+    // Disconnecting removes the closures from the listeners: collect them first
+    GArray *handler_ids = g_array_sized_new (FALSE, FALSE, sizeof (gulong), listeners->len);
+
+    for (guint i = 0; i < listeners->len; i++) {
+        Closure *closure = (Closure *) g_ptr_array_index (listeners, i);
+
+        if (event == NULL || strcmp (closure->event, event) == 0)
+            g_array_append_val (handler_ids, closure->handler_id);
+    }
+
+    for (guint i = 0; i < handler_ids->len; i++)
+        g_signal_handler_disconnect (gobject, g_array_index (handler_ids, gulong, i));
+
+    g_array_free (handler_ids, TRUE);
+    g_free (event);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+/*
+ * Signal emission. The query of each (GType, detailed signal name) is
+ * resolved once, and kept in a table on the type.
+ */
+
+struct SignalEmission {
+    guint   signal_id;
+    GQuark  detail;
+    guint   n_params;
+    GType  *param_types; // without G_SIGNAL_TYPE_STATIC_SCOPE
+    GType   return_type; // idem
+};
+
+static void SignalEmissionFree(gpointer data) {
+    auto *emission = (SignalEmission *) data;
+    g_free (emission->param_types);
+    g_free (emission);
+}
+
+static SignalEmission* GetSignalEmission(GType gtype, const char *detailed_name) {
+    auto *table = (GHashTable *) g_type_get_qdata (gtype, GNodeJS::signal_query_quark());
+
+    if (table == NULL) {
+        table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, SignalEmissionFree);
+        g_type_set_qdata (gtype, GNodeJS::signal_query_quark(), table);
+    }
+
+    auto *emission = (SignalEmission *) g_hash_table_lookup (table, detailed_name);
+
+    if (emission != NULL)
+        return emission;
+
+    guint signal_id;
+    GQuark detail;
+
+    if (!g_signal_parse_name (detailed_name, gtype, &signal_id, &detail, TRUE))
+        return NULL;
+
+    GSignalQuery query;
+    g_signal_query (signal_id, &query);
+
+    emission = g_new0 (SignalEmission, 1);
+    emission->signal_id = signal_id;
+    emission->detail = detail;
+    emission->n_params = query.n_params;
+    emission->param_types = g_new (GType, query.n_params);
+    emission->return_type = query.return_type & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+
+    for (guint i = 0; i < query.n_params; i++)
+        emission->param_types[i] = query.param_types[i] & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+
+    g_hash_table_insert (table, g_strdup (detailed_name), emission);
+
+    return emission;
+}
+
+/**
+ * Emits a signal
+ * @param signal the signal name, with an optional detail
+ * @param ...args the signal arguments
+ * @returns the signal return value, if any
+ */
+NAN_METHOD(SignalEmit) {
+    GObject *gobject = GObjectFromWrapper (info.This ());
+
+    if (!gobject) {
+        Nan::ThrowTypeError("Object is not a GObject");
+        return;
+    }
+
+    if (!info[0]->IsString()) {
+        Nan::ThrowTypeError("Signal ID invalid");
+        return;
+    }
+
+    Nan::Utf8String signal_name (info[0]);
+    SignalEmission *emission = GetSignalEmission (G_OBJECT_TYPE (gobject), *signal_name);
+
+    if (emission == NULL) {
+        char *message = g_strdup_printf("Signal \"%s\" not found for instance of %s",
+                *signal_name, G_OBJECT_TYPE_NAME (gobject));
+        Nan::ThrowError(message);
+        g_free(message);
+        return;
+    }
+
+    guint n_params = emission->n_params;
+
+    if ((guint) info.Length() - 1 < n_params) {
+        char *message = g_strdup_printf("Signal \"%s\" expects %u arguments, got %d",
+                *signal_name, n_params, info.Length() - 1);
+        Nan::ThrowError(message);
+        g_free(message);
+        return;
+    }
+
+    GValue *values = g_newa (GValue, n_params + 1);
+    memset (values, 0, sizeof (GValue) * (n_params + 1));
+    guint n_values = 1;
+
+    GValue return_value = G_VALUE_INIT;
+
+    g_value_init (&values[0], G_OBJECT_TYPE (gobject));
+    g_value_set_object (&values[0], gobject);
+
+    for (guint i = 0; i < n_params; i++) {
+        GValue *gvalue = &values[i + 1];
+        Local<Value> value = info[i + 1];
+
+        g_value_init (gvalue, emission->param_types[i]);
+        n_values++;
+
+        if (!CanConvertV8ToGValue (gvalue, value)) {
+            char *message = g_strdup_printf("Cannot convert argument %u of signal \"%s\", expected type %s",
+                    i + 1, *signal_name, g_type_name (emission->param_types[i]));
+            Nan::ThrowTypeError(message);
+            g_free(message);
+            goto out;
+        }
+
+        if (!V8ToGValue (gvalue, value)) {
+            // Error will already be thrown from V8ToGValue
+            goto out;
+        }
+    }
+
+    if (emission->return_type != G_TYPE_NONE) {
+        g_value_init (&return_value, emission->return_type);
+        g_signal_emitv (values, emission->signal_id, emission->detail, &return_value);
+        info.GetReturnValue().Set(GValueToV8 (&return_value));
+        g_value_unset (&return_value);
+    } else {
+        g_signal_emitv (values, emission->signal_id, emission->detail, NULL);
+    }
+
+out:
+    for (guint i = 0; i < n_values; i++)
+        g_value_unset (&values[i]);
+}
+
+static GParamSpec* FindClassProperty(GObjectClass *klass, const char *name) {
+    GParamSpec *pspec = g_object_class_find_property (klass, name);
+
+    // Also accept JS-style names, e.g. "defaultWidth"
+    if (pspec == NULL) {
+        char *dashed_name = Util::ToDashCase (name);
+        pspec = g_object_class_find_property (klass, dashed_name);
+        g_free (dashed_name);
+    }
+
+    return pspec;
+}
+
+GParamSpec* FindProperty(GObject *gobject, const char *name) {
+    return FindClassProperty (G_OBJECT_GET_CLASS (gobject), name);
+}
+
+static void ThrowPropertyError(const char *format, const char *name) {
+    char *message = g_strdup_printf(format, name);
+    Nan::ThrowError(message);
+    g_free(message);
+}
+
+/**
+ * Reads many properties at once
+ * @param names the property names
+ * @returns an object mapping each name to its value
+ */
+NAN_METHOD(GetProperties) {
+    GObject *gobject = GObjectFromWrapper (info.This ());
+
+    if (!gobject) {
+        Nan::ThrowTypeError("Object is not a GObject");
+        return;
+    }
+
+    if (!info[0]->IsArray()) {
+        Nan::ThrowTypeError("Expected an array of property names");
+        return;
+    }
+
+    Local<Array> names = info[0].As<Array>();
+    Local<Object> result = Nan::New<Object>();
+    uint32_t n_names = names->Length();
+
+    for (uint32_t i = 0; i < n_names; i++) {
+        Local<Value> name = Nan::Get(names, i).ToLocalChecked();
+        Nan::Utf8String name_utf8 (name);
+        GParamSpec *pspec = FindProperty (gobject, *name_utf8);
+
+        if (pspec == NULL) {
+            ThrowPropertyError("Unexistent property \"%s\"", *name_utf8);
+            return;
+        }
+
+        if ((pspec->flags & G_PARAM_READABLE) == 0) {
+            ThrowPropertyError("Property \"%s\" is not readable", *name_utf8);
+            return;
+        }
+
+        GValue value = {};
+        g_value_init (&value, G_PARAM_SPEC_VALUE_TYPE (pspec));
+        g_object_get_property (gobject, pspec->name, &value);
+        Nan::Set(result, name, GValueToV8(&value));
+        g_value_unset (&value);
+    }
+
+    info.GetReturnValue().Set(result);
+}
+
+/**
+ * Sets many properties at once. All values are converted before any
+ * of them is set, and the "notify" emissions are coalesced by freezing
+ * notifications for the duration of the update.
+ * @param properties an object mapping property names to values
+ */
+NAN_METHOD(SetProperties) {
+    GObject *gobject = GObjectFromWrapper (info.This ());
+
+    if (!gobject) {
+        Nan::ThrowTypeError("Object is not a GObject");
+        return;
+    }
+
+    if (!info[0]->IsObject()) {
+        Nan::ThrowTypeError("Expected an object of properties");
+        return;
+    }
+
+    Local<Object> properties = info[0].As<Object>();
+    Local<Array> names = properties->GetOwnPropertyNames();
+    uint32_t n_properties = names->Length();
+
+    GParamSpec **pspecs = g_new0 (GParamSpec *, n_properties);
+    GValue *values = g_new0 (GValue, n_properties);
+    uint32_t n_converted = 0;
+
+    for (; n_converted < n_properties; n_converted++) {
+        Local<Value> name = Nan::Get(names, n_converted).ToLocalChecked();
+        Local<Value> value = Nan::Get(properties, name).ToLocalChecked();
+        Nan::Utf8String name_utf8 (name);
+        GParamSpec *pspec = FindProperty (gobject, *name_utf8);
+
+        if (pspec == NULL) {
+            ThrowPropertyError("Unexistent property \"%s\"", *name_utf8);
+            goto out;
+        }
+
+        if ((pspec->flags & G_PARAM_WRITABLE) == 0 || (pspec->flags & G_PARAM_CONSTRUCT_ONLY) != 0) {
+            ThrowPropertyError("Property \"%s\" is not writable", *name_utf8);
+            goto out;
+        }
+
+        GValue *gvalue = &values[n_converted];
+        g_value_init (gvalue, G_PARAM_SPEC_VALUE_TYPE (pspec));
+
+        if (!CanConvertV8ToGValue (gvalue, value) || !V8ToGValue (gvalue, value)) {
+            char* message = g_strdup_printf("Cannot convert value for property \"%s\", expected type %s",
+                    *name_utf8, g_type_name(G_VALUE_TYPE (gvalue)));
+            Nan::ThrowTypeError(message);
+            g_free(message);
+            g_value_unset (gvalue);
+            goto out;
+        }
+
+        pspecs[n_converted] = pspec;
+    }
+
+    g_object_freeze_notify (gobject);
+    for (uint32_t i = 0; i < n_properties; i++)
+        g_object_set_property (gobject, pspecs[i]->name, &values[i]);
+    g_object_thaw_notify (gobject);
+
+out:
+    for (uint32_t i = 0; i < n_converted; i++)
+        g_value_unset (&values[i]);
+
+    g_free (pspecs);
+    g_free (values);
+}
+
 NAN_METHOD(GObjectToString) {
     Local<Object> self = info.This();
 
@@ -315,18 +967,34 @@ NAN_METHOD(GObjectToString) {
     }
 
     GObject* g_object = GObjectFromWrapper(self);
-    GType type = G_OBJECT_TYPE (g_object);
+    Nan::Utf8String className (self->GetConstructorName());
+
+    if (g_object == NULL) {
+        char *str = g_strdup_printf("[%s (released)]", *className);
+        info.GetReturnValue().Set(UTF8(str));
+        g_free(str);
+        return;
+    }
 
+    GType type = G_OBJECT_TYPE (g_object);
     const char* typeName = g_type_name(type);
-    char *className = *Nan::Utf8String(self->GetConstructorName());
     void *address = self->GetAlignedPointerFromInternalField(0);
 
-    char *str = g_strdup_printf("[%s:%s %#zx]", typeName, className, (unsigned long)address);
+    char *str = g_strdup_printf("[%s:%s %#zx]", typeName, *className, (unsigned long)address);
 
     info.GetReturnValue().Set(UTF8(str));
     g_free(str);
 }
 
+NAN_METHOD(GObjectRelease) {
+    if (!ValueHasInternalField(info.This())) {
+        Nan::ThrowTypeError("Object is not a GObject");
+        return;
+    }
+
+    ReleaseGObject (info.This());
+}
+
 Local<FunctionTemplate> GetBaseClassTemplate() {
     static bool isBaseClassCreated = false;
 
@@ -336,6 +1004,14 @@ Local<FunctionTemplate> GetBaseClassTemplate() {
         Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>();
         Nan::SetPrototypeMethod(tpl, "connect", SignalConnect);
         Nan::SetPrototypeMethod(tpl, "disconnect", SignalDisconnect);
+        Nan::SetPrototypeMethod(tpl, "on", SignalOn);
+        Nan::SetPrototypeMethod(tpl, "once", SignalOnce);
+        Nan::SetPrototypeMethod(tpl, "off", SignalOff);
+        Nan::SetPrototypeMethod(tpl, "removeAllListeners", SignalRemoveAllListeners);
+        Nan::SetPrototypeMethod(tpl, "emit", SignalEmit);
+        Nan::SetPrototypeMethod(tpl, "getProperties", GetProperties);
+        Nan::SetPrototypeMethod(tpl, "setProperties", SetProperties);
+        Nan::SetPrototypeMethod(tpl, "release", GObjectRelease);
         Nan::SetPrototypeMethod(tpl, "toString", GObjectToString);
         baseTemplate.Reset(tpl);
     }
@@ -354,6 +1030,13 @@ static Local<FunctionTemplate> NewClassTemplate (GIBaseInfo *info, GType gtype)
     tpl->SetClassName (UTF8(class_name));
     tpl->InstanceTemplate()->SetInternalFieldCount(1);
 
+    /* Defined on the template so that every instance gets it at creation,
+     * whether through the constructor or WrapperFromGObject */
+    Nan::SetTemplate(tpl->InstanceTemplate(),
+            "__gtype__",
+            Nan::New<Number>(gtype),
+            (v8::PropertyAttribute)(v8::PropertyAttribute::ReadOnly | v8::PropertyAttribute::DontEnum));
+
     GIObjectInfo *parent_info = g_object_info_get_parent (info);
     if (parent_info) {
         auto parent_tpl = GetClassTemplateFromGI ((GIBaseInfo *) parent_info);
@@ -404,23 +1087,39 @@ Local<Value> WrapperFromGObject(GObject *gobject) {
     if (gobject == NULL)
         return Nan::Null();
 
-    void *data = g_object_get_qdata (gobject, GNodeJS::object_quark());
+    ObjectRecord *record = GetObjectRecord (gobject);
 
-    if (data) {
+    if (record) {
         /* Easy case: we already have an object. */
-        auto *persistent = (Persistent<Object> *) data;
-        auto obj = New<Object> (*persistent);
+        auto obj = New<Object> (record->persistent);
         return obj;
 
     } else {
         GType gtype = G_OBJECT_TYPE(gobject);
         g_type_ensure (gtype); //void *klass = g_type_class_ref (type);
 
-        auto tpl = GetClassTemplate(NULL, gtype);
-        Local<Function> constructor = tpl->GetFunction ();
-        Local<Value> gobject_external = New<External> (gobject);
-        Local<Value> args[] = { gobject_external };
-        Local<Object> obj = Nan::NewInstance(constructor, 1, args).ToLocalChecked();
+        /* Types without introspection data (e.g. registered from JS) use
+         * the template of their closest introspected ancestor */
+        GType template_gtype = GetIntrospectedType (gtype);
+
+        /* Instantiate directly from the template, rather than going
+         * through a construct call of GObjectConstructor */
+        auto tpl = GetClassTemplate(NULL, template_gtype);
+        Local<Object> obj = Nan::NewInstance(tpl->InstanceTemplate()).ToLocalChecked();
+
+        if (gtype != template_gtype) {
+            Local<Function> subclass = GetSubclassConstructor (gtype);
+
+            if (!subclass.IsEmpty ())
+                Nan::SetPrototype (obj, Nan::Get (subclass, UTF8("prototype")).ToLocalChecked ());
+
+            Nan::DefineOwnProperty(obj,
+                    UTF8("__gtype__"),
+                    Nan::New<Number>(gtype),
+                    (v8::PropertyAttribute)(v8::PropertyAttribute::ReadOnly | v8::PropertyAttribute::DontEnum));
+        }
+
+        AssociateGObject (Isolate::GetCurrent(), obj, gobject);
 
         return obj;
     }
@@ -437,4 +1136,38 @@ GObject * GObjectFromWrapper(Local<Value> value) {
     return gobject;
 }
 
+/**
+ * Counts the GObject wrapper records in use, and allocated
+ */
+void GetGObjectWrapperStats (guint32 *live, guint32 *capacity) {
+    *live = objectRecords.Live ();
+    *capacity = objectRecords.Capacity ();
+}
+
+/**
+ * Returns the toggle counters of each GType, by type name
+ */
+Local<Object> GetToggleStats () {
+    Local<Object> stats = Nan::New<Object> ();
+
+    if (toggleCounters == NULL)
+        return stats;
+
+    GHashTableIter iter;
+    gpointer key, value;
+    g_hash_table_iter_init (&iter, toggleCounters);
+
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        auto *counters = (ToggleCounters *) value;
+        Local<Object> entry = Nan::New<Object> ();
+
+        Nan::Set (entry, UTF8("toggles"), Nan::New<Number> ((double) counters->toggles));
+        Nan::Set (entry, UTF8("weakened"), Nan::New<Number> ((double) counters->weakened));
+        Nan::Set (entry, UTF8("strengthened"), Nan::New<Number> ((double) counters->strengthened));
+        Nan::Set (stats, UTF8(g_type_name ((GType) GPOINTER_TO_SIZE (key))), entry);
+    }
+
+    return stats;
+}
+
 };
@@ -17,6 +17,10 @@ namespace GNodeJS {
 Local<Function>         MakeClass            (GIBaseInfo *info);
 Local<Value>            WrapperFromGObject   (GObject *object);
 GObject *               GObjectFromWrapper   (Local<Value> value);
+GParamSpec *            FindProperty         (GObject *gobject, const char *name);
+void                    ReleaseGObject       (Local<v8::Object> wrapper);
 Local<FunctionTemplate> GetBaseClassTemplate ();
+void                    GetGObjectWrapperStats (guint32 *live, guint32 *capacity);
+Local<v8::Object>       GetToggleStats       ();
 
 };
@@ -0,0 +1,86 @@
+/*
+ * intern.cc
+ *
+ * Cache of internalized strings, for the strings returned from C without
+ * ownership. Those are mostly static or long-lived (type names, property
+ * names, enum nicks, ...) and returned over and over: the cache avoids
+ * creating a new string from UTF-8 each time. It is a fixed-size table
+ * indexed by the hash of the content, a collision replaces the previous
+ * string of the slot.
+ */
+
+#include <string.h>
+
+#include "intern.h"
+
+namespace GNodeJS {
+
+#define INTERN_CAPACITY   1024  // power of 2
+#define INTERN_MAX_LENGTH 64    // longer strings are not cached
+
+struct InternEntry {
+    guint   hash;
+    guint   length;
+    char   *data;
+    Nan::Persistent<String> string;
+};
+
+static InternEntry *entries = NULL;
+static InternStats  stats = { 0, 0, 0, INTERN_CAPACITY };
+
+
+static Local<String> NewInternalizedString (const char *data, int length) {
+    return v8::String::NewFromUtf8 (v8::Isolate::GetCurrent (), data,
+            v8::NewStringType::kInternalized, length).ToLocalChecked ();
+}
+
+/**
+ * Returns a string with the content of @data, from the cache if it was
+ * seen before
+ */
+Local<String> InternString (const char *data) {
+    /* djb hash, as g_str_hash, measuring the length on the way */
+    guint hash = 5381;
+    guint length = 0;
+
+    for (const char *p = data; *p != '\0'; p++, length++) {
+        if (length == INTERN_MAX_LENGTH)
+            return Nan::New<String> (data).ToLocalChecked ();
+        hash = (hash << 5) + hash + (signed char) *p;
+    }
+
+    if (entries == NULL)
+        entries = new InternEntry[INTERN_CAPACITY] ();
+
+    InternEntry *entry = &entries[hash & (INTERN_CAPACITY - 1)];
+
+    if (entry->data != NULL
+            && entry->hash == hash
+            && entry->length == length
+            && memcmp (entry->data, data, length) == 0) {
+        stats.hits++;
+        return Nan::New<String> (entry->string);
+    }
+
+    stats.misses++;
+
+    Local<String> string = NewInternalizedString (data, length);
+
+    if (entry->data == NULL)
+        stats.entries++;
+    else
+        g_free (entry->data);
+
+    entry->hash = hash;
+    entry->length = length;
+    entry->data = g_strndup (data, length);
+    entry->string.Reset (string);
+
+    return string;
+}
+
+void GetInternStringStats (InternStats *result) {
+    *result = stats;
+}
+
+};
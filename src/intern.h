@@ -0,0 +1,26 @@
+/*
+ * intern.h
+ */
+
+#pragma once
+
+#include <node.h>
+#include <nan.h>
+#include <glib.h>
+
+using v8::Local;
+using v8::String;
+
+namespace GNodeJS {
+
+struct InternStats {
+    guint64 hits;
+    guint64 misses;
+    guint   entries;   // slots holding a string
+    guint   capacity;  // slots in the cache
+};
+
+Local<String> InternString         (const char *data);
+void          GetInternStringStats (InternStats *stats);
+
+};
@@ -0,0 +1,144 @@
+/*
+ * memory.cc
+ *
+ * Reports the native memory behind wrappers to V8, so that the GC feels
+ * the pressure of large native objects held by small JS wrappers.
+ */
+
+#include "debug.h"
+#include "memory.h"
+
+using v8::Function;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+namespace GNodeJS {
+
+struct SizeHook {
+    ExternalSizeFunc func;
+    Nan::Persistent<Function> callback;
+};
+
+static GHashTable *hooks = NULL;    // type name => SizeHook*
+static GHashTable *resolved = NULL; // GType => SizeHook*, or NULL if none applies
+
+
+static size_t BytesSize (gpointer instance) {
+    return g_bytes_get_size ((GBytes *) instance);
+}
+
+static void SizeHookFree (gpointer data) {
+    auto *hook = (SizeHook *) data;
+    hook->callback.Reset();
+    delete hook;
+}
+
+static void EnsureHooks () {
+    if (hooks != NULL)
+        return;
+
+    hooks = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, SizeHookFree);
+    resolved = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    RegisterExternalSize ("GBytes", BytesSize);
+}
+
+static SizeHook* AddHook (const char *type_name) {
+    EnsureHooks ();
+
+    auto *hook = new SizeHook();
+    hook->func = NULL;
+
+    g_hash_table_replace (hooks, g_strdup (type_name), hook);
+    // Hooks apply to subtypes as well: resolve them again
+    g_hash_table_remove_all (resolved);
+
+    return hook;
+}
+
+/**
+ * Finds the hook for @gtype, or for its closest ancestor that has one
+ */
+static SizeHook* FindHook (GType gtype) {
+    EnsureHooks ();
+
+    gpointer result;
+    if (g_hash_table_lookup_extended (resolved, GSIZE_TO_POINTER (gtype), NULL, &result))
+        return (SizeHook *) result;
+
+    SizeHook *hook = NULL;
+    for (GType type = gtype; type != 0 && hook == NULL; type = g_type_parent (type))
+        hook = (SizeHook *) g_hash_table_lookup (hooks, g_type_name (type));
+
+    g_hash_table_insert (resolved, GSIZE_TO_POINTER (gtype), hook);
+
+    return hook;
+}
+
+void RegisterExternalSize (const char *type_name, ExternalSizeFunc func) {
+    SizeHook *hook = AddHook (type_name);
+    hook->func = func;
+}
+
+void RegisterExternalSize (const char *type_name, Local<Function> callback) {
+    SizeHook *hook = AddHook (type_name);
+    hook->callback.Reset (callback);
+}
+
+/**
+ * Removes the hook registered for @type_name. Wrappers created before keep
+ * the size reported for them until they are released.
+ */
+void UnregisterExternalSize (const char *type_name) {
+    EnsureHooks ();
+
+    if (g_hash_table_remove (hooks, type_name))
+        g_hash_table_remove_all (resolved);
+}
+
+/**
+ * Computes the native size of @instance with the hook registered for its type
+ * @param wrapper the JS wrapper of @instance, passed to JS hooks
+ * @param size (out) the size in bytes
+ * @returns false if no hook applies to @gtype
+ */
+bool GetExternalSize (GType gtype, gpointer instance, Local<Object> wrapper, size_t *size) {
+    if (gtype == G_TYPE_NONE || gtype == G_TYPE_INVALID)
+        return false;
+
+    SizeHook *hook = FindHook (gtype);
+
+    if (hook == NULL)
+        return false;
+
+    if (hook->func != NULL) {
+        *size = hook->func (instance);
+        return true;
+    }
+
+    Local<Function> callback = Nan::New (hook->callback);
+    Local<Value> args[] = { wrapper };
+
+    Nan::TryCatch try_catch;
+    auto result = Nan::Call (callback, wrapper, 1, args);
+
+    if (try_catch.HasCaught() || result.IsEmpty() || !result.ToLocalChecked()->IsNumber()) {
+        warn("external size hook failed for %s", g_type_name (gtype));
+        *size = 0;
+        return true;
+    }
+
+    double value = result.ToLocalChecked()->NumberValue();
+    *size = value > 0 ? (size_t) value : 0;
+    return true;
+}
+
+void AdjustExternalSize (int64_t change) {
+    // Not Nan::AdjustExternalMemory, which takes an int: sizes can exceed 2 GiB
+    if (change != 0)
+        v8::Isolate::GetCurrent()->AdjustAmountOfExternalAllocatedMemory (change);
+}
+
+};
@@ -0,0 +1,28 @@
+/*
+ * memory.h
+ */
+
+#pragma once
+
+#include <node.h>
+#include <nan.h>
+#include <glib-object.h>
+
+using v8::Function;
+using v8::Local;
+using v8::Object;
+
+namespace GNodeJS {
+
+/*
+ * Returns the number of bytes of native memory owned by @instance
+ */
+typedef size_t (*ExternalSizeFunc) (gpointer instance);
+
+void RegisterExternalSize (const char *type_name, ExternalSizeFunc func);
+void RegisterExternalSize (const char *type_name, Local<Function> callback);
+void UnregisterExternalSize (const char *type_name);
+bool GetExternalSize      (GType gtype, gpointer instance, Local<Object> wrapper, size_t *size);
+void AdjustExternalSize   (int64_t change);
+
+};
@@ -0,0 +1,80 @@
+/*
+ * release.cc
+ *
+ * Release scopes: every wrapper created while a scope is active is
+ * released when the scope is popped, instead of waiting for the GC.
+ */
+
+#include <glib.h>
+
+#include "boxed.h"
+#include "gobject.h"
+#include "release.h"
+
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+namespace GNodeJS {
+
+struct ScopedWrapper {
+    Nan::Persistent<Object> wrapper;
+    WrapperKind kind;
+};
+
+static GPtrArray *scopes = NULL; // GPtrArray* of ScopedWrapper*, innermost last
+
+
+void PushReleaseScope () {
+    if (scopes == NULL)
+        scopes = g_ptr_array_new ();
+
+    g_ptr_array_add (scopes, g_ptr_array_new ());
+}
+
+/**
+ * Releases the wrappers created since the matching PushReleaseScope
+ * @param keep a value that must not be released (e.g. the scope's result).
+ * It is handed to the outer scope, if any.
+ */
+void PopReleaseScope (Local<Value> keep) {
+    if (scopes == NULL || scopes->len == 0)
+        return;
+
+    auto *scope = (GPtrArray *) g_ptr_array_remove_index (scopes, scopes->len - 1);
+
+    for (guint i = 0; i < scope->len; i++) {
+        auto *entry = (ScopedWrapper *) g_ptr_array_index (scope, i);
+        Local<Object> wrapper = Nan::New (entry->wrapper);
+
+        if (wrapper->StrictEquals (keep)) {
+            TrackWrapper (wrapper, entry->kind);
+        } else if (entry->kind == WRAPPER_GOBJECT) {
+            ReleaseGObject (wrapper);
+        } else {
+            ReleaseBoxed (wrapper);
+        }
+
+        entry->wrapper.Reset ();
+        delete entry;
+    }
+
+    g_ptr_array_unref (scope);
+}
+
+/**
+ * Records @wrapper in the innermost release scope, if any
+ */
+void TrackWrapper (Local<Object> wrapper, WrapperKind kind) {
+    if (scopes == NULL || scopes->len == 0)
+        return;
+
+    auto *scope = (GPtrArray *) g_ptr_array_index (scopes, scopes->len - 1);
+    auto *entry = new ScopedWrapper();
+    entry->wrapper.Reset (wrapper);
+    entry->kind = kind;
+
+    g_ptr_array_add (scope, entry);
+}
+
+};
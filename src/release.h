@@ -0,0 +1,25 @@
+/*
+ * release.h
+ */
+
+#pragma once
+
+#include <node.h>
+#include <nan.h>
+
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+namespace GNodeJS {
+
+enum WrapperKind {
+    WRAPPER_GOBJECT,
+    WRAPPER_BOXED,
+};
+
+void PushReleaseScope ();
+void PopReleaseScope  (Local<Value> keep);
+void TrackWrapper     (Local<Object> wrapper, WrapperKind kind);
+
+};
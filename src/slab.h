@@ -0,0 +1,89 @@
+/*
+ * slab.h
+ */
+
+#pragma once
+
+#include <new>
+#include <type_traits>
+
+#include <glib.h>
+
+namespace GNodeJS {
+
+/**
+ * Records of type T allocated in chunks of CHUNK_SIZE, so that wrappers
+ * don't each need their own small allocation. Records are addressed by
+ * handles (1-based indexes, 0 is never valid) that fit in a qdata pointer.
+ * Freed slots are reused last-in first-out, and records never move, so
+ * pointers to a record stay valid until it is freed. Chunks are kept for
+ * the lifetime of the slab.
+ */
+template <typename T, guint32 CHUNK_SIZE = 512>
+class Slab {
+public:
+    Slab () : chunks (NULL), n_chunks (0), free_head (0), live (0), capacity (0) {}
+
+    /* Allocates a default-constructed record */
+    guint32 Alloc () {
+        if (free_head == 0)
+            Grow ();
+
+        guint32 handle = free_head;
+        Slot *slot = GetSlot (handle);
+        free_head = slot->next_free;
+
+        new (&slot->storage) T ();
+        live++;
+
+        return handle;
+    }
+
+    void Free (guint32 handle) {
+        Slot *slot = GetSlot (handle);
+
+        ((T *) &slot->storage)->~T ();
+        slot->next_free = free_head;
+        free_head = handle;
+        live--;
+    }
+
+    T *Get (guint32 handle) {
+        return (T *) &GetSlot (handle)->storage;
+    }
+
+    guint32 Live ()     const { return live; }
+    guint32 Capacity () const { return capacity; }
+
+private:
+    union Slot {
+        guint32 next_free;  // when free: handle of the next free slot, or 0
+        typename std::aligned_storage<sizeof (T), alignof (T)>::type storage;
+    };
+
+    Slot   **chunks;
+    guint32  n_chunks;
+    guint32  free_head;
+    guint32  live;
+    guint32  capacity;
+
+    Slot *GetSlot (guint32 handle) {
+        guint32 index = handle - 1;
+        return &chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    }
+
+    void Grow () {
+        Slot *chunk = g_new (Slot, CHUNK_SIZE);
+
+        chunks = g_renew (Slot *, chunks, n_chunks + 1);
+        chunks[n_chunks++] = chunk;
+
+        for (guint32 i = 0; i < CHUNK_SIZE; i++)
+            chunk[i].next_free = i + 1 < CHUNK_SIZE ? capacity + i + 2 : 0;
+
+        free_head = capacity + 1;
+        capacity += CHUNK_SIZE;
+    }
+};
+
+};
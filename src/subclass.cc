@@ -0,0 +1,390 @@
+/*
+ * subclass.cc
+ *
+ * GTypes implemented in JS. When a class is registered, the virtual
+ * functions of its parent classes and of its interfaces that have a
+ * matching `vfunc_` + lowerCamelCase method on the JS prototype get a
+ * native trampoline. The trampolines are written in the class and
+ * interface structures when GLib initializes them, and keep the JS
+ * method found at registration, so dispatch doesn't look up names.
+ */
+
+#include <string.h>
+
+#include "boxed.h"
+#include "debug.h"
+#include "error.h"
+#include "gi.h"
+#include "gobject.h"
+#include "loop.h"
+#include "subclass.h"
+#include "type.h"
+#include "util.h"
+#include "value.h"
+
+using v8::Context;
+using v8::Function;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+namespace GNodeJS {
+
+static int FindFieldOffset (GIStructInfo *struct_info, const char *name) {
+    int n_fields = g_struct_info_get_n_fields (struct_info);
+
+    for (int i = 0; i < n_fields; i++) {
+        GIFieldInfo *field = g_struct_info_get_field (struct_info, i);
+        bool matches = strcmp (g_base_info_get_name (field), name) == 0;
+        int offset = g_field_info_get_offset (field);
+        g_base_info_unref (field);
+
+        if (matches)
+            return offset;
+    }
+
+    return -1;
+}
+
+static void InstallVFunc (gpointer vtable, GIStructInfo *struct_info, VFuncTrampoline *trampoline) {
+    const char *name = g_base_info_get_name (trampoline->info);
+    int offset = FindFieldOffset (struct_info, name);
+
+    if (offset < 0) {
+        warn("no slot found for virtual function %s", name);
+        return;
+    }
+
+    G_STRUCT_MEMBER (gpointer, vtable, offset) = (gpointer) trampoline->closure;
+}
+
+void Subclass::ClassInit (gpointer g_class, gpointer class_data) {
+    auto *subclass = (Subclass *) class_data;
+
+    for (guint i = 0; i < subclass->vfuncs->len; i++) {
+        auto *trampoline = (VFuncTrampoline *) g_ptr_array_index (subclass->vfuncs, i);
+
+        if (!GI_IS_OBJECT_INFO (trampoline->container))
+            continue;
+
+        GIStructInfo *struct_info = g_object_info_get_class_struct (trampoline->container);
+        if (struct_info == NULL)
+            continue;
+
+        InstallVFunc (g_class, struct_info, trampoline);
+        g_base_info_unref (struct_info);
+    }
+}
+
+void Subclass::InterfaceInit (gpointer g_iface, gpointer iface_data) {
+    auto *subclass = (Subclass *) iface_data;
+    GType iface_gtype = G_TYPE_FROM_INTERFACE (g_iface);
+
+    for (guint i = 0; i < subclass->vfuncs->len; i++) {
+        auto *trampoline = (VFuncTrampoline *) g_ptr_array_index (subclass->vfuncs, i);
+
+        if (!GI_IS_INTERFACE_INFO (trampoline->container)
+                || g_registered_type_info_get_g_type (trampoline->container) != iface_gtype)
+            continue;
+
+        GIStructInfo *struct_info = g_interface_info_get_iface_struct (trampoline->container);
+        if (struct_info == NULL)
+            continue;
+
+        InstallVFunc (g_iface, struct_info, trampoline);
+        g_base_info_unref (struct_info);
+    }
+}
+
+/**
+ * Stores @arg as the return value of an ffi closure, where integers
+ * smaller than a register must be widened
+ */
+static void StoreReturnValue (GITypeInfo *type_info, GIArgument *arg, void *result) {
+    switch (GetStorageType (type_info)) {
+        case GI_TYPE_TAG_BOOLEAN:
+            *(ffi_sarg *) result = arg->v_boolean;
+            break;
+        case GI_TYPE_TAG_INT8:
+            *(ffi_sarg *) result = arg->v_int8;
+            break;
+        case GI_TYPE_TAG_UINT8:
+            *(ffi_arg *) result = arg->v_uint8;
+            break;
+        case GI_TYPE_TAG_INT16:
+            *(ffi_sarg *) result = arg->v_int16;
+            break;
+        case GI_TYPE_TAG_UINT16:
+            *(ffi_arg *) result = arg->v_uint16;
+            break;
+        case GI_TYPE_TAG_INT32:
+            *(ffi_sarg *) result = arg->v_int32;
+            break;
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+            *(ffi_arg *) result = arg->v_uint32;
+            break;
+        case GI_TYPE_TAG_FLOAT:
+            *(gfloat *) result = arg->v_float;
+            break;
+        case GI_TYPE_TAG_DOUBLE:
+            *(gdouble *) result = arg->v_double;
+            break;
+        default:
+            *(GIArgument *) result = *arg;
+            break;
+    }
+}
+
+/**
+ * Takes a reference on a returned object or boxed, when the caller owns it
+ */
+static void TransferReturnValue (GITypeInfo *type_info, GIArgument *arg) {
+    if (arg->v_pointer == NULL || g_type_info_get_tag (type_info) != GI_TYPE_TAG_INTERFACE)
+        return;
+
+    GIBaseInfo *interface_info = g_type_info_get_interface (type_info);
+    GIInfoType interface_type = g_base_info_get_type (interface_info);
+
+    if (interface_type == GI_INFO_TYPE_OBJECT || interface_type == GI_INFO_TYPE_INTERFACE) {
+        g_object_ref (arg->v_pointer);
+    } else if (interface_type == GI_INFO_TYPE_BOXED
+            || interface_type == GI_INFO_TYPE_STRUCT
+            || interface_type == GI_INFO_TYPE_UNION) {
+        GType gtype = g_registered_type_info_get_g_type (interface_info);
+        if (G_TYPE_IS_BOXED (gtype))
+            arg->v_pointer = g_boxed_copy (gtype, arg->v_pointer);
+    }
+
+    g_base_info_unref (interface_info);
+}
+
+/**
+ * FFI closure callback. Only IN arguments are passed to JS.
+ */
+void VFuncTrampoline::Call (ffi_cif *cif, void *result, void **args, gpointer user_data) {
+    auto *trampoline = (VFuncTrampoline *) user_data;
+    GIVFuncInfo *info = trampoline->info;
+
+    Nan::HandleScope scope;
+    Local<Context> context = Nan::New (trampoline->subclass->context);
+    Context::Scope context_scope (context);
+
+    GObject *instance = *(GObject **) args[0];
+    Local<Object> self = WrapperFromGObject (instance).As<Object> ();
+
+    int n_args = g_callable_info_get_n_args (info);
+    int n_js_args = 0;
+
+    /* Boxed arguments are lent to the implementation, see boxed.h */
+    BorrowScope borrow_scope;
+
+    #ifndef __linux__
+        Local<Value>* js_args = new Local<Value>[n_args];
+    #else
+        Local<Value> js_args[n_args];
+    #endif
+
+    for (int i = 0; i < n_args; i++) {
+        GIArgInfo arg_info;
+        GITypeInfo type_info;
+        g_callable_info_load_arg (info, i, &arg_info);
+
+        if (g_arg_info_get_direction (&arg_info) != GI_DIRECTION_IN)
+            continue;
+
+        g_arg_info_load_type (&arg_info, &type_info);
+        js_args[n_js_args++] = GIArgumentToV8 (&type_info, (GIArgument *) args[i + 1], -1,
+                g_arg_info_get_ownership_transfer (&arg_info));
+    }
+
+    borrow_scope.Seal ();
+
+    Local<Function> fn = Nan::New (trampoline->fn);
+
+    Nan::TryCatch try_catch;
+
+    auto js_result = Nan::Call (fn, self, n_js_args, js_args);
+
+    GITypeInfo return_type;
+    g_callable_info_load_return_type (info, &return_type);
+
+    if (g_type_info_get_tag (&return_type) != GI_TYPE_TAG_VOID || g_type_info_is_pointer (&return_type)) {
+        GIArgument return_value = {};
+
+        if (!js_result.IsEmpty ()) {
+            Local<Value> value = js_result.ToLocalChecked ();
+            bool didConvert = V8ToGIArgument (
+                    &return_type,
+                    &return_value,
+                    value,
+                    g_callable_info_may_return_null (info));
+
+            if (!didConvert)
+                Throw::InvalidReturnValue (&return_type, value);
+            else if (g_callable_info_get_caller_owns (info) == GI_TRANSFER_EVERYTHING)
+                TransferReturnValue (&return_type, &return_value);
+        }
+
+        StoreReturnValue (&return_type, &return_value, result);
+    }
+
+    if (try_catch.HasCaught ()) {
+        GNodeJS::QuitLoopStack ();
+        try_catch.ReThrow ();
+    }
+
+    #ifndef __linux__
+        delete[] js_args;
+    #endif
+}
+
+/**
+ * Creates the trampolines for the virtual functions of @container
+ * (an object or interface info) that @prototype implements
+ */
+static void AddVFuncs (Subclass *subclass, GIBaseInfo *container, Local<Object> prototype) {
+    bool is_object = GI_IS_OBJECT_INFO (container);
+    int n_vfuncs = is_object ?
+        g_object_info_get_n_vfuncs (container) :
+        g_interface_info_get_n_vfuncs (container);
+
+    for (int i = 0; i < n_vfuncs; i++) {
+        GIVFuncInfo *vfunc_info = is_object ?
+            g_object_info_get_vfunc (container, i) :
+            g_interface_info_get_vfunc (container, i);
+
+        char *camel_name = Util::ToCamelCase (g_base_info_get_name (vfunc_info));
+        char *method_name = g_strdup_printf ("vfunc_%s", camel_name);
+        Local<Value> method = Nan::Get (prototype, UTF8(method_name)).ToLocalChecked ();
+
+        if (method->IsFunction ()) {
+            auto *trampoline = new VFuncTrampoline ();
+            trampoline->subclass = subclass;
+            trampoline->info = g_base_info_ref (vfunc_info);
+            trampoline->container = g_base_info_ref (container);
+            trampoline->fn.Reset (method.As<Function> ());
+            trampoline->closure = g_callable_info_prepare_closure (
+                    vfunc_info, &trampoline->cif, VFuncTrampoline::Call, trampoline);
+
+            g_ptr_array_add (subclass->vfuncs, trampoline);
+        }
+
+        g_free (method_name);
+        g_free (camel_name);
+        g_base_info_unref (vfunc_info);
+    }
+}
+
+/**
+ * Registers a new GType, subclass of @parent, implemented by @constructor
+ * @param interfaces the GTypes of the implemented interfaces
+ * @returns the new GType, or G_TYPE_INVALID if a JS exception has been thrown
+ */
+GType RegisterClass (const char *name, GType parent, GArray *interfaces, Local<Function> constructor) {
+    if (g_type_from_name (name) != 0) {
+        char *message = g_strdup_printf ("Type \"%s\" is already registered", name);
+        Nan::ThrowError (message);
+        g_free (message);
+        return G_TYPE_INVALID;
+    }
+
+    if (!g_type_is_a (parent, G_TYPE_OBJECT)) {
+        Nan::ThrowTypeError ("Parent type is not a GObject type");
+        return G_TYPE_INVALID;
+    }
+
+    GTypeQuery query;
+    g_type_query (parent, &query);
+
+    auto *subclass = new Subclass ();
+    subclass->vfuncs = g_ptr_array_new ();
+    subclass->constructor.Reset (constructor);
+    subclass->context.Reset (Nan::GetCurrentContext ());
+
+    Local<Object> prototype = Nan::Get (constructor, UTF8("prototype")).ToLocalChecked ()->ToObject ();
+
+    for (GType type = parent; type != G_TYPE_INVALID; type = g_type_parent (type)) {
+        GIBaseInfo *info = g_irepository_find_by_gtype (NULL, type);
+
+        if (info == NULL)
+            continue;
+
+        if (GI_IS_OBJECT_INFO (info))
+            AddVFuncs (subclass, info, prototype);
+
+        g_base_info_unref (info);
+    }
+
+    for (guint i = 0; i < interfaces->len; i++) {
+        GIBaseInfo *info = g_irepository_find_by_gtype (NULL, g_array_index (interfaces, GType, i));
+
+        if (info == NULL)
+            continue;
+
+        if (GI_IS_INTERFACE_INFO (info))
+            AddVFuncs (subclass, info, prototype);
+
+        g_base_info_unref (info);
+    }
+
+    GTypeInfo type_info = {};
+    type_info.class_size = query.class_size;
+    type_info.class_init = Subclass::ClassInit;
+    type_info.class_data = subclass;
+    type_info.instance_size = query.instance_size;
+
+    subclass->gtype = g_type_register_static (parent, name, &type_info, (GTypeFlags) 0);
+
+    if (subclass->gtype == G_TYPE_INVALID) {
+        char *message = g_strdup_printf ("Couldn't register type \"%s\"", name);
+        Nan::ThrowError (message);
+        g_free (message);
+        return G_TYPE_INVALID;
+    }
+
+    GInterfaceInfo interface_info = { Subclass::InterfaceInit, NULL, subclass };
+
+    for (guint i = 0; i < interfaces->len; i++)
+        g_type_add_interface_static (subclass->gtype, g_array_index (interfaces, GType, i), &interface_info);
+
+    g_type_set_qdata (subclass->gtype, GNodeJS::subclass_quark(), subclass);
+
+    return subclass->gtype;
+}
+
+/**
+ * Finds the JS class of @gtype, or of its closest ancestor registered from JS
+ * @returns the class, or an empty handle
+ */
+Local<Function> GetSubclassConstructor (GType gtype) {
+    for (GType type = gtype; type != G_TYPE_INVALID; type = g_type_parent (type)) {
+        auto *subclass = (Subclass *) g_type_get_qdata (type, GNodeJS::subclass_quark());
+
+        if (subclass != NULL)
+            return Nan::New (subclass->constructor);
+    }
+
+    return Local<Function> ();
+}
+
+/**
+ * Finds @gtype, or its closest ancestor, that has introspection data
+ */
+GType GetIntrospectedType (GType gtype) {
+    for (GType type = gtype; type != G_TYPE_INVALID; type = g_type_parent (type)) {
+        if (g_type_get_qdata (type, GNodeJS::template_quark()) != NULL)
+            return type;
+
+        GIBaseInfo *info = g_irepository_find_by_gtype (NULL, type);
+
+        if (info != NULL) {
+            g_base_info_unref (info);
+            return type;
+        }
+    }
+
+    return gtype;
+}
+
+};
@@ -0,0 +1,55 @@
+/*
+ * subclass.h
+ */
+
+#pragma once
+
+#include <node.h>
+#include <nan.h>
+#include <girepository.h>
+#include <glib-object.h>
+#include <ffi.h>
+#include <girffi.h>
+
+using v8::Function;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+namespace GNodeJS {
+
+struct Subclass;
+
+/*
+ * A native implementation of a virtual function, dispatching to the JS
+ * method that was found on the class prototype at registration.
+ */
+struct VFuncTrampoline {
+    Subclass       *subclass;
+    GIVFuncInfo    *info;
+    GIBaseInfo     *container; // GIObjectInfo or GIInterfaceInfo
+    ffi_cif         cif;
+    ffi_closure    *closure;
+    Nan::Persistent<Function> fn;
+
+    static void Call (ffi_cif *cif, void *result, void **args, gpointer user_data);
+};
+
+/*
+ * A GType registered from a JS class
+ */
+struct Subclass {
+    GType gtype;
+    Nan::Persistent<Function> constructor;
+    Nan::Persistent<v8::Context> context;
+    GPtrArray *vfuncs; // VFuncTrampoline*
+
+    static void ClassInit     (gpointer g_class, gpointer class_data);
+    static void InterfaceInit (gpointer g_iface, gpointer iface_data);
+};
+
+GType           RegisterClass       (const char *name, GType parent, GArray *interfaces, Local<Function> constructor);
+Local<Function> GetSubclassConstructor (GType gtype);
+GType           GetIntrospectedType (GType gtype);
+
+};
@@ -5,6 +5,7 @@
  * Distributed under terms of the MIT license.
  */
 
+#include <string.h>
 #include <node.h>
 #include <nan.h>
 #include <girepository.h>
@@ -44,6 +45,104 @@ char* GetSignalName(const char* signal_detail) {
     return signal_name;
 }
 
+/**
+ * Converts a JS-style property name (camelCase or snake_case) to the
+ * canonical GObject form (dash-case), e.g. "defaultWidth" => "default-width"
+ */
+char* ToDashCase(const char* name) {
+    GString *result = g_string_sized_new (strlen (name) + 4);
+
+    for (const char *c = name; *c != '\0'; c++) {
+        if (g_ascii_isupper (*c)) {
+            if (c != name)
+                g_string_append_c (result, '-');
+            g_string_append_c (result, g_ascii_tolower (*c));
+        } else if (*c == '_') {
+            g_string_append_c (result, '-');
+        } else {
+            g_string_append_c (result, *c);
+        }
+    }
+
+    return g_string_free (result, FALSE);
+}
+
+static bool IsBreak (char c) {
+    return c == '\0' || !g_ascii_isalnum (c);
+}
+
+/*
+ * Length of the word at @c, split as lodash's `words` (4.3) does for ASCII
+ */
+static int MatchWord (const char *c) {
+    int n_upper = 0;
+    int n_lower;
+
+    while (g_ascii_isupper (c[n_upper]))
+        n_upper++;
+
+    if (n_upper == 0 && g_ascii_isdigit (*c)) {
+        int length = 0;
+        while (g_ascii_isdigit (c[length]))
+            length++;
+        return length;
+    }
+
+    // An optional upper-case letter and lower-case letters: "Word", "word"
+    int start = n_upper > 0 ? 1 : 0;
+    for (n_lower = 0; g_ascii_islower (c[start + n_lower]); n_lower++);
+
+    if (n_lower > 0 && n_upper <= 1) {
+        char next = c[start + n_lower];
+        if (IsBreak (next) || g_ascii_isupper (next))
+            return start + n_lower;
+    }
+
+    // Upper-case letters, not counting the first letter of a next word: "XMLHttp" => "XML"
+    if (n_upper > 0) {
+        char next = c[n_upper];
+
+        if (IsBreak (next))
+            return n_upper;
+        if (g_ascii_islower (next) && n_upper > 1)
+            return n_upper - 1;
+    }
+
+    if (n_lower > 0 && n_upper <= 1)
+        return start + n_lower;
+
+    return n_upper;
+}
+
+/**
+ * Converts a GObject-style name (dash-case or snake_case) to the JS
+ * form (lowerCamelCase), e.g. "default-width" => "defaultWidth". Words
+ * are split as lodash's camelCase does (used for the other names in
+ * lib/), e.g. "matrix_3d" => "matrix3D", "FOO_BAR" => "fooBar".
+ */
+char* ToCamelCase(const char* name) {
+    GString *result = g_string_sized_new (strlen (name));
+    const char *c = name;
+
+    while (*c != '\0') {
+        if (!g_ascii_isalnum (*c)) {
+            c++;
+            continue;
+        }
+
+        int length = MatchWord (c);
+
+        for (int i = 0; i < length; i++) {
+            bool upper = i == 0 && result->len > 0;
+            g_string_append_c (result, upper ? g_ascii_toupper (c[i]) : g_ascii_tolower (c[i]));
+        }
+
+        c += length;
+    }
+
+    return g_string_free (result, FALSE);
+}
+
 
 /**
  * This function is used to call "process._tickCallback()" inside NodeJS.
@@ -14,6 +14,8 @@ namespace Util
 {
     const char*    ArrayTypeToString (GIArrayType array_type);
     char*          GetSignalName(const char* signal_detail);
+    char*          ToDashCase(const char* name);
+    char*          ToCamelCase(const char* name);
 
     void           CallNextTickCallback();
 
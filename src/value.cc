@@ -4,9 +4,11 @@
 #include <glib.h>
 
 #include "boxed.h"
+#include "field.h"
 #include "function.h"
 #include "gi.h"
 #include "gobject.h"
+#include "intern.h"
 #include "param_spec.h"
 #include "type.h"
 #include "util.h"
@@ -32,8 +34,39 @@ static void HashPointerToGIArgument (GIArgument *arg, GITypeInfo *type_info);
 
 static bool IsUint8Array (GITypeInfo *type_info);
 
+/* Whether arrays of structs are returned as columns, see field.cc */
+static bool columnarStructs = false;
 
-Local<Value> GIArgumentToV8(GITypeInfo *type_info, GIArgument *arg, long length) {
+/* Whether hash tables are returned as Maps rather than objects */
+static bool hashAsMap = false;
+
+/**
+ * Sets whether arrays of structs are converted to columns
+ * @returns the previous setting
+ */
+bool SetColumnarStructs (bool enabled) {
+    bool previous = columnarStructs;
+    columnarStructs = enabled;
+    return previous;
+}
+
+/**
+ * Sets whether hash tables are converted to Maps
+ * @returns the previous setting
+ */
+bool SetHashAsMap (bool enabled) {
+    bool previous = hashAsMap;
+    hashAsMap = enabled;
+    return previous;
+}
+
+
+/**
+ * @param transfer the ownership transfer of @arg: boxed values that are not
+ * transferred stay owned by the caller (see WrapperFromUnownedBoxed), and
+ * strings that are not are interned (see intern.cc)
+ */
+Local<Value> GIArgumentToV8(GITypeInfo *type_info, GIArgument *arg, long length, GITransfer transfer) {
     GITypeTag type_tag = g_type_info_get_tag (type_info);
 
     switch (type_tag) {
@@ -99,10 +132,12 @@ Local<Value> GIArgumentToV8(GITypeInfo *type_info, GIArgument *arg, long length)
         }
 
     case GI_TYPE_TAG_UTF8:
-        if (arg->v_string)
-            return New<String>(arg->v_string).ToLocalChecked();
-        else
+        if (arg->v_string == NULL)
             return Nan::EmptyString();
+        else if (transfer == GI_TRANSFER_NOTHING)
+            return InternString(arg->v_string);
+        else
+            return New<String>(arg->v_string).ToLocalChecked();
 
     case GI_TYPE_TAG_INTERFACE:
         {
@@ -124,7 +159,10 @@ Local<Value> GIArgumentToV8(GITypeInfo *type_info, GIArgument *arg, long length)
             case GI_INFO_TYPE_BOXED:
             case GI_INFO_TYPE_STRUCT:
             case GI_INFO_TYPE_UNION:
-                value = WrapperFromBoxed (interface_info, arg->v_pointer);
+                if (transfer == GI_TRANSFER_EVERYTHING)
+                    value = WrapperFromBoxed (interface_info, arg->v_pointer);
+                else
+                    value = WrapperFromUnownedBoxed (interface_info, arg->v_pointer);
                 break;
             case GI_INFO_TYPE_ENUM:
             case GI_INFO_TYPE_FLAGS:
@@ -161,13 +199,33 @@ Local<Value> GIArgumentToV8(GITypeInfo *type_info, GIArgument *arg, long length)
     }
 }
 
+/**
+ * Converts @length strings (or up to the first NULL if -1), without going
+ * through GIArgumentToV8 for each element
+ */
+static Local<Array> StringArrayToV8 (char **strings, long length) {
+    if (length == -1)
+        length = g_strv_length (strings);
+
+    Local<Array> array = New<Array>(length);
+
+    for (long i = 0; i < length; i++) {
+        if (strings[i])
+            Nan::Set(array, i, New<String>(strings[i]).ToLocalChecked());
+        else
+            Nan::Set(array, i, Nan::EmptyString());
+    }
+
+    return array;
+}
+
 Local<Value> GListToV8 (GITypeInfo *type_info, GList *glist) {
     GITypeInfo *param_info = g_type_info_get_param_type(type_info, 0);
 
     g_assert(param_info != NULL);
 
     GIArgument arg;
-    Local<Array> array = New<Array>();
+    Local<Array> array = New<Array>(g_list_length (glist));
 
     int i = 0;
     for (; glist != NULL; glist = glist->next) {
@@ -184,7 +242,7 @@ Local<Value> GSListToV8 (GITypeInfo *type_info, GSList *list) {
     GITypeInfo *param_info = g_type_info_get_param_type(type_info, 0);
     g_assert(param_info != NULL);
 
-    Local<Array> array = New<Array>();
+    Local<Array> array = New<Array>(g_slist_length (list));
 
     GIArgument arg;
     int i = 0;
@@ -202,7 +260,14 @@ Local<Value> GHashToV8 (GITypeInfo *type_info, GHashTable *hash_table) {
     GITypeInfo *key_info   = g_type_info_get_param_type (type_info, 0);
     GITypeInfo *value_info = g_type_info_get_param_type (type_info, 1);
 
-    Local<Object> object = New<Object>();
+    /* Maps keep keys that aren't strings (numbers, objects) as they are */
+    Local<v8::Map> map;
+    Local<Object> object;
+
+    if (hashAsMap)
+        map = v8::Map::New (v8::Isolate::GetCurrent());
+    else
+        object = New<Object>();
 
     GHashTableIter iter;
     GIArgument key_arg;
@@ -210,37 +275,192 @@ Local<Value> GHashToV8 (GITypeInfo *type_info, GHashTable *hash_table) {
     g_hash_table_iter_init (&iter, hash_table);
     while (g_hash_table_iter_next (&iter, &key_arg.v_pointer, &value_arg.v_pointer))
     {
+        HashPointerToGIArgument(&key_arg, key_info);
         HashPointerToGIArgument(&value_arg, value_info);
 
         auto key   = GIArgumentToV8(key_info, &key_arg);
         auto value = GIArgumentToV8(value_info, &value_arg);
 
-        Nan::Set(object, key, value);
+        if (hashAsMap)
+            map = map->Set(Nan::GetCurrentContext(), key, value).ToLocalChecked();
+        else
+            Nan::Set(object, key, value);
     }
 
     g_base_info_unref(key_info);
     g_base_info_unref(value_info);
 
+    if (hashAsMap)
+        return map;
     return object;
 }
 
-Local<Value> ArrayToV8 (GITypeInfo *type_info, void* data, long length) {
+/**
+ * Whether numbers of @tag have a typed array type
+ */
+bool IsTypedArrayElement (GITypeTag tag) {
+    switch (tag) {
+        case GI_TYPE_TAG_INT8:
+        case GI_TYPE_TAG_UINT8:
+        case GI_TYPE_TAG_INT16:
+        case GI_TYPE_TAG_UINT16:
+        case GI_TYPE_TAG_INT32:
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR:
+        case GI_TYPE_TAG_FLOAT:
+        case GI_TYPE_TAG_DOUBLE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Creates a typed array of @tag over @buffer
+ */
+Local<Value> MakeTypedArray (GITypeTag tag, Local<v8::ArrayBuffer> buffer, size_t length) {
+    switch (tag) {
+        case GI_TYPE_TAG_INT8:    return v8::Int8Array::New (buffer, 0, length);
+        case GI_TYPE_TAG_UINT8:   return v8::Uint8Array::New (buffer, 0, length);
+        case GI_TYPE_TAG_INT16:   return v8::Int16Array::New (buffer, 0, length);
+        case GI_TYPE_TAG_UINT16:  return v8::Uint16Array::New (buffer, 0, length);
+        case GI_TYPE_TAG_INT32:   return v8::Int32Array::New (buffer, 0, length);
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR: return v8::Uint32Array::New (buffer, 0, length);
+        case GI_TYPE_TAG_FLOAT:   return v8::Float32Array::New (buffer, 0, length);
+        case GI_TYPE_TAG_DOUBLE:  return v8::Float64Array::New (buffer, 0, length);
+        default:
+            g_assert_not_reached ();
+            return Nan::Undefined ();
+    }
+}
+
+/**
+ * Whether @value is a typed array of numbers of @tag
+ */
+bool IsTypedArrayOf (GITypeTag tag, Local<Value> value) {
+    switch (tag) {
+        case GI_TYPE_TAG_INT8:    return value->IsInt8Array ();
+        case GI_TYPE_TAG_UINT8:   return value->IsUint8Array ();
+        case GI_TYPE_TAG_INT16:   return value->IsInt16Array ();
+        case GI_TYPE_TAG_UINT16:  return value->IsUint16Array ();
+        case GI_TYPE_TAG_INT32:   return value->IsInt32Array ();
+        case GI_TYPE_TAG_UINT32:
+        case GI_TYPE_TAG_UNICHAR: return value->IsUint32Array ();
+        case GI_TYPE_TAG_FLOAT:   return value->IsFloat32Array ();
+        case GI_TYPE_TAG_DOUBLE:  return value->IsFloat64Array ();
+        default:                  return false;
+    }
+}
 
-    auto array = New<Array>();
+/**
+ * Gets the memory of @value if it is an ArrayBufferView of the elements of
+ * the array @type_info: a typed array of the same type, or any view (e.g.
+ * a Buffer) for arrays of bytes
+ * @param length the number of elements
+ */
+bool GetArrayBufferViewData (GITypeInfo *type_info, Local<Value> value, void **data, long *length) {
+    if (!value->IsArrayBufferView ())
+        return false;
 
-    if (data == nullptr || length == 0)
-        return array;
+    GITypeInfo *element_info = g_type_info_get_param_type (type_info, 0);
+    GITypeTag tag = g_type_info_get_tag (element_info);
+    bool is_pointer = g_type_info_is_pointer (element_info);
+    g_base_info_unref (element_info);
+
+    if (is_pointer || !IsTypedArrayElement (tag))
+        return false;
+
+    gsize element_size = GetTypeTagSize (tag);
+
+    if (element_size != 1 && !IsTypedArrayOf (tag, value))
+        return false;
+
+    Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView> ();
+    *data = (char *) view->Buffer ()->GetContents ().Data () + view->ByteOffset ();
+    *length = view->ByteLength () / element_size;
+    return true;
+}
+
+/**
+ * Returns the number of elements of @element_size before the first zero
+ * element of @data
+ */
+static long GetZeroTerminatedLength (void *data, gsize element_size) {
+    long length = 0;
+
+    for (char *element = (char *) data; ; element += element_size, length++) {
+        gsize i = 0;
+
+        while (i < element_size && element[i] == 0)
+            i++;
+
+        if (i == element_size)
+            return length;
+    }
+}
+
+static void FreeAdoptedCArray (char *data, void *hint) {
+    g_free (data);
+}
+
+static void FreeAdoptedGArray (char *data, void *hint) {
+    g_array_free ((GArray *) hint, TRUE);
+}
+
+/**
+ * Converts the @length numbers at @data to a typed array of @tag.
+ * @param container the memory to take over instead of copying, if any:
+ * @data itself for C arrays, or its GArray
+ */
+static Local<Value> NumericArrayToV8 (GITypeTag tag, void *data, long length, GIArrayType array_type, void *container) {
+    size_t byte_length = length * GetTypeTagSize (tag);
+    Local<v8::ArrayBuffer> buffer;
+
+    if (container != NULL) {
+        /* The node Buffer frees the memory when it is collected */
+        Local<Object> adopted = array_type == GI_ARRAY_TYPE_C ?
+            Nan::NewBuffer ((char *) data, byte_length, FreeAdoptedCArray, NULL).ToLocalChecked() :
+            Nan::NewBuffer ((char *) data, byte_length, FreeAdoptedGArray, container).ToLocalChecked();
+
+        buffer = adopted.As<v8::Uint8Array>()->Buffer();
+    } else {
+        buffer = v8::ArrayBuffer::New (v8::Isolate::GetCurrent(), byte_length);
+
+        if (byte_length > 0)
+            memcpy (buffer->GetContents().Data(), data, byte_length);
+    }
+
+    return MakeTypedArray (tag, buffer, length);
+}
+
+/**
+ * Converts a C array, GArray, GByteArray or GPtrArray
+ * @param length the length of a C array, if not zero-terminated or fixed-size
+ * @param adopt if not NULL, where the caller holds @data with ownership
+ * (transfer full). Numeric arrays then take the memory over rather than
+ * copying it, and set *@adopt to NULL so that the caller doesn't free it.
+ */
+Local<Value> ArrayToV8 (GITypeInfo *type_info, void* data, long length, gpointer *adopt) {
+
+    Local<Array> array = New<Array>();
 
     auto array_type = g_type_info_get_array_type (type_info);
     auto* elem_type_info = g_type_info_get_param_type (type_info, 0);
     auto  element_size = GetTypeSize (elem_type_info);
     auto is_zero_terminated = g_type_info_is_zero_terminated (type_info);
+    auto elem_tag = g_type_info_get_tag (elem_type_info);
+    bool is_numeric = !g_type_info_is_pointer (elem_type_info) && IsTypedArrayElement (elem_tag);
+    void *container = data;
+
+    if (data == nullptr || length == 0)
+        goto out;
 
     switch (array_type) {
         case GI_ARRAY_TYPE_C:
             {
                 if (is_zero_terminated) {
-                    length = g_strv_length ((gchar **)data);
+                    length = GetZeroTerminatedLength (data, element_size);
                 }
                 else if (length == -1) {
                     length = g_type_info_get_array_fixed_size (type_info);
@@ -275,10 +495,74 @@ Local<Value> ArrayToV8 (GITypeInfo *type_info, void* data, long length) {
             break;
     }
 
+    /* e.g. a GArray of gint16 annotated as gint */
+    if (is_numeric && (gsize) element_size != GetTypeTagSize (elem_tag))
+        is_numeric = false;
+
     if (data == nullptr || length == 0)
         goto out;
 
 
+    /*
+     * Numeric arrays are typed arrays. Their memory is taken over when
+     * it is ours, and copied at once otherwise.
+     */
+
+    if (is_numeric) {
+        bool can_adopt = adopt != NULL && *adopt == container;
+        Local<Value> result = NumericArrayToV8 (elem_tag, data, length, array_type, can_adopt ? container : NULL);
+
+        if (can_adopt)
+            *adopt = NULL;
+
+        g_base_info_unref(elem_type_info);
+        return result;
+    }
+
+
+    array = New<Array>(length);
+
+
+    /*
+     * Arrays of strings, e.g. GStrv
+     */
+
+    if (elem_tag == GI_TYPE_TAG_UTF8 && element_size == sizeof (char *)) {
+        g_base_info_unref(elem_type_info);
+        return StringArrayToV8 ((char **) data, length);
+    }
+
+
+    /*
+     * Arrays of structs stored inline or as pointers
+     */
+
+    if (g_type_info_get_tag (elem_type_info) == GI_TYPE_TAG_INTERFACE) {
+        GIBaseInfo *columns_info = columnarStructs ? GetColumnsStructInfo (elem_type_info) : NULL;
+        bool is_pointer = g_type_info_is_pointer (elem_type_info);
+
+        if (columns_info != NULL) {
+            Local<Value> columns = StructArrayToColumns (columns_info, data, length, element_size, is_pointer);
+            g_base_info_unref (columns_info);
+            g_base_info_unref (elem_type_info);
+            return columns;
+        }
+
+        if (!is_pointer) {
+            GIBaseInfo *interface_info = g_type_info_get_interface (elem_type_info);
+
+            /* The elements belong to the array: they are copied */
+            for (int i = 0; i < length; i++) {
+                void *element = (void *)((ulong)data + i * element_size);
+                Nan::Set(array, i, WrapperFromUnownedBoxed (interface_info, element));
+            }
+
+            g_base_info_unref (interface_info);
+            goto out;
+        }
+    }
+
+
     /*
      * Fill array elements
      */
@@ -294,13 +578,40 @@ Local<Value> ArrayToV8 (GITypeInfo *type_info, void* data, long length) {
 
 out:
     g_base_info_unref(elem_type_info);
+
+    if (is_numeric && array->Length() == 0)
+        return NumericArrayToV8 (elem_tag, NULL, 0, array_type, NULL);
+
     return array;
 }
 
 
+/**
+ * Returns the struct info of the elements of @type_info if they are
+ * structs stored inline and @value is a columns object (see field.cc)
+ * to convert to them, or NULL
+ */
+static GIBaseInfo * GetColumnsInputInfo(GITypeInfo *type_info, Local<Value> value) {
+    GITypeInfo *element_info = g_type_info_get_param_type (type_info, 0);
+    GIBaseInfo *struct_info = g_type_info_is_pointer (element_info) ?
+        NULL : GetColumnsStructInfo (element_info);
+
+    g_base_info_unref (element_info);
+
+    if (struct_info != NULL && GetColumnsLength (value) < 0) {
+        g_base_info_unref (struct_info);
+        struct_info = NULL;
+    }
+
+    return struct_info;
+}
+
 GArray * V8ToGArray(GITypeInfo *type_info, Local<Value> value) {
     GArray* g_array = NULL;
     bool zero_terminated = g_type_info_is_zero_terminated(type_info);
+    void *data;
+    long view_length;
+    GIBaseInfo *struct_info;
 
     if (value->IsString()) {
         Local<String> string = value->ToString();
@@ -309,9 +620,36 @@ GArray * V8ToGArray(GITypeInfo *type_info, Local<Value> value) {
         if (length == 0)
             return g_array_new(zero_terminated, TRUE, sizeof(char));
 
-        const char *utf8_data = *Nan::Utf8String(string);
+        length = string->Utf8Length();
         g_array = g_array_sized_new (zero_terminated, FALSE, sizeof (char), length);
-        return g_array_append_vals(g_array, utf8_data, length);
+        g_array_set_size (g_array, length);
+        string->WriteUtf8 (g_array->data, length, NULL, String::NO_NULL_TERMINATION);
+        return g_array;
+
+    } else if (GetArrayBufferViewData (type_info, value, &data, &view_length)) {
+        GITypeInfo* element_info = g_type_info_get_param_type (type_info, 0);
+        gsize element_size = GetTypeSize (element_info);
+        g_base_info_unref (element_info);
+
+        g_array = g_array_sized_new (zero_terminated, FALSE, element_size, view_length);
+        return g_array_append_vals (g_array, data, view_length);
+
+    } else if ((struct_info = GetColumnsInputInfo (type_info, value)) != NULL) {
+        GITypeInfo* element_info = g_type_info_get_param_type (type_info, 0);
+        long length = GetColumnsLength (value);
+        gsize element_size = GetTypeSize (element_info);
+
+        g_array = g_array_sized_new (zero_terminated, TRUE, element_size, length);
+        g_array_set_size (g_array, length);
+
+        if (!ColumnsToStructArray (struct_info, value.As<Object>(), g_array->data, length, element_size)) {
+            g_array_free (g_array, TRUE);
+            g_array = NULL;
+        }
+
+        g_base_info_unref (struct_info);
+        g_base_info_unref (element_info);
+        return g_array;
 
     } else if (value->IsArray ()) {
         auto array = Local<Array>::Cast (value->ToObject ());
@@ -347,9 +685,45 @@ void * V8ToCArray(GITypeInfo *type_info, Local<Value> value) {
     bool is_zero_terminated = g_type_info_is_zero_terminated(type_info);
 
     if (value->IsString()) {
-        Local<String> string = value->ToString();
-        const char *utf8_data = *Nan::Utf8String(string);
-        return g_strdup(utf8_data);
+        return V8ToUtf8 (value->ToString());
+    }
+
+    void *data;
+    long view_length;
+
+    if (GetArrayBufferViewData (type_info, value, &data, &view_length)) {
+        GITypeInfo* element_info = g_type_info_get_param_type (type_info, 0);
+        gsize element_size = GetTypeSize (element_info);
+        g_base_info_unref (element_info);
+
+        /* One copy, see FunctionCall for the arrays passed without copy */
+        gsize byte_length = view_length * element_size;
+        void *result = malloc(byte_length + (is_zero_terminated ? element_size : 0));
+
+        memcpy(result, data, byte_length);
+        if (is_zero_terminated)
+            memset((char *) result + byte_length, 0, element_size);
+
+        return result;
+    }
+
+    GIBaseInfo *struct_info = GetColumnsInputInfo (type_info, value);
+
+    if (struct_info != NULL) {
+        GITypeInfo* element_info = g_type_info_get_param_type (type_info, 0);
+        long length = GetColumnsLength (value);
+        gsize element_size = GetTypeSize (element_info);
+
+        void *result = calloc(length + (is_zero_terminated ? 1 : 0), element_size);
+
+        if (!ColumnsToStructArray (struct_info, value.As<Object>(), result, length, element_size)) {
+            free(result);
+            result = NULL;
+        }
+
+        g_base_info_unref (struct_info);
+        g_base_info_unref (element_info);
+        return result;
     }
 
     if (!value->IsArray()) {
@@ -456,7 +830,22 @@ gpointer V8ToGHash (GITypeInfo *type_info, Local<Value> value) {
     GHashFunc  hash_func;
     GEqualFunc equal_func;
 
+    /* Integer keys are packed in the key pointer (see GIArgumentToHashPointer),
+     * so they are hashed and compared as pointers */
     switch (key_type_tag) {
+        case GI_TYPE_TAG_INT64:
+        case GI_TYPE_TAG_UINT64:
+        case GI_TYPE_TAG_FLOAT:
+        case GI_TYPE_TAG_DOUBLE:
+            {
+                char* message = g_strdup_printf("Hash table keys of type %s are not supported",
+                        g_type_tag_to_string(key_type_tag));
+                Nan::ThrowTypeError(message);
+                g_free(message);
+                g_base_info_unref(key_type_info);
+                g_base_info_unref(value_type_info);
+                return NULL;
+            }
         case GI_TYPE_TAG_GTYPE:
         case GI_TYPE_TAG_UNICHAR:
         case GI_TYPE_TAG_BOOLEAN:
@@ -466,19 +855,6 @@ gpointer V8ToGHash (GITypeInfo *type_info, Local<Value> value) {
         case GI_TYPE_TAG_UINT16:
         case GI_TYPE_TAG_INT32:
         case GI_TYPE_TAG_UINT32:
-            hash_func  = g_int_hash;
-            equal_func = g_int_equal;
-            break;
-        case GI_TYPE_TAG_INT64:
-        case GI_TYPE_TAG_UINT64:
-            hash_func  = g_int64_hash;
-            equal_func = g_int64_equal;
-            break;
-        case GI_TYPE_TAG_FLOAT:
-        case GI_TYPE_TAG_DOUBLE:
-            hash_func  = g_double_hash;
-            equal_func = g_double_equal;
-            break;
         case GI_TYPE_TAG_ARRAY:
         case GI_TYPE_TAG_INTERFACE:
         case GI_TYPE_TAG_GLIST:
@@ -499,12 +875,17 @@ gpointer V8ToGHash (GITypeInfo *type_info, Local<Value> value) {
     GHashTable* hash_table = g_hash_table_new (hash_func, equal_func);
 
 
+    /* Maps are read as [key, value, ...], objects by own property */
     auto object = value->ToObject();
-    auto keys = object->GetOwnPropertyNames();
+    bool is_map = value->IsMap();
+    auto entries = is_map ? value.As<v8::Map>()->AsArray() : object->GetOwnPropertyNames();
+    uint32_t n_entries = is_map ? entries->Length() / 2 : entries->Length();
 
-    for (uint32_t i = 0; i < keys->Length(); i++) {
-        auto key   = Nan::Get(keys, i).ToLocalChecked();
-        auto value = Nan::Get(object, key).ToLocalChecked();
+    for (uint32_t i = 0; i < n_entries; i++) {
+        auto key   = Nan::Get(entries, is_map ? 2 * i : i).ToLocalChecked();
+        auto value = is_map ?
+            Nan::Get(entries, 2 * i + 1).ToLocalChecked() :
+            Nan::Get(object, key).ToLocalChecked();
 
         GIArgument key_arg;
         GIArgument value_arg;
@@ -523,7 +904,9 @@ gpointer V8ToGHash (GITypeInfo *type_info, Local<Value> value) {
             goto item_error;
         }
 
-        g_hash_table_insert (hash_table, key_arg.v_pointer, GIArgumentToHashPointer (&value_arg, value_type_info));
+        g_hash_table_insert (hash_table,
+                GIArgumentToHashPointer (&key_arg, key_type_info),
+                GIArgumentToHashPointer (&value_arg, value_type_info));
 
         continue;
 
@@ -633,9 +1016,7 @@ bool V8ToGIArgument(GITypeInfo *type_info, GIArgument *arg, Local<Value> value,
         break;
 
     case GI_TYPE_TAG_UTF8:
-        {
-            arg->v_pointer = g_strdup (*Nan::Utf8String(value));
-        }
+        arg->v_pointer = V8ToUtf8 (value->ToString());
         break;
 
     case GI_TYPE_TAG_FILENAME:
@@ -777,6 +1158,21 @@ bool CanConvertV8ToGIArgument(GITypeInfo *type_info, Local<Value> value, bool ma
             if (value->IsString () && IsUint8Array(type_info))
                 return true;
 
+            if (type_tag == GI_TYPE_TAG_ARRAY) {
+                GIBaseInfo *struct_info = GetColumnsInputInfo (type_info, value);
+
+                if (struct_info != NULL) {
+                    g_base_info_unref (struct_info);
+                    return true;
+                }
+            }
+
+            if (type_tag == GI_TYPE_TAG_ARRAY && value->IsArrayBufferView ()) {
+                void *data;
+                long length;
+                return GetArrayBufferViewData (type_info, value, &data, &length);
+            }
+
             if (!value->IsArray ())
                 return false;
 
@@ -1081,10 +1477,22 @@ void FreeGIArgumentArray(GITypeInfo *type_info, GIArgument *arg, GITransfer tran
 bool V8ToGValue(GValue *gvalue, Local<Value> value) {
     if (G_VALUE_HOLDS_BOOLEAN (gvalue)) {
         g_value_set_boolean (gvalue, value->BooleanValue ());
-    } else if (G_VALUE_HOLDS_INT (gvalue) || G_VALUE_HOLDS_LONG (gvalue)) {
+    } else if (G_VALUE_HOLDS_CHAR (gvalue)) {
+        g_value_set_schar (gvalue, value->Int32Value ());
+    } else if (G_VALUE_HOLDS_UCHAR (gvalue)) {
+        g_value_set_uchar (gvalue, value->Uint32Value ());
+    } else if (G_VALUE_HOLDS_INT (gvalue)) {
         g_value_set_int (gvalue, value->Int32Value ());
     } else if (G_VALUE_HOLDS_UINT (gvalue)) {
         g_value_set_uint (gvalue, value->Uint32Value ());
+    } else if (G_VALUE_HOLDS_LONG (gvalue)) {
+        g_value_set_long (gvalue, value->IntegerValue ());
+    } else if (G_VALUE_HOLDS_ULONG (gvalue)) {
+        g_value_set_ulong (gvalue, value->NumberValue ());
+    } else if (G_VALUE_HOLDS_INT64 (gvalue)) {
+        g_value_set_int64 (gvalue, value->IntegerValue ());
+    } else if (G_VALUE_HOLDS_UINT64 (gvalue)) {
+        g_value_set_uint64 (gvalue, value->NumberValue ());
     } else if (G_VALUE_HOLDS_FLOAT (gvalue)) {
         g_value_set_float (gvalue, value->NumberValue ());
     } else if (G_VALUE_HOLDS_DOUBLE (gvalue)) {
@@ -1102,6 +1510,12 @@ bool V8ToGValue(GValue *gvalue, Local<Value> value) {
         g_value_set_string (gvalue, data);
     } else if (G_VALUE_HOLDS_ENUM (gvalue)) {
         g_value_set_enum (gvalue, value->Int32Value ());
+    } else if (G_VALUE_HOLDS_FLAGS (gvalue)) {
+        g_value_set_flags (gvalue, value->Uint32Value ());
+    } else if (G_VALUE_HOLDS_OBJECT (gvalue) && value->IsNull ()) {
+        g_value_set_object (gvalue, NULL);
+    } else if (G_VALUE_HOLDS_BOXED (gvalue) && value->IsNull ()) {
+        g_value_set_boxed (gvalue, NULL);
     } else if (G_VALUE_HOLDS_OBJECT (gvalue)) {
         if (!ValueIsInstanceOfGType(value, G_VALUE_TYPE (gvalue))) {
             Nan::ThrowTypeError("Value is not instance of GObject");
@@ -1120,9 +1534,6 @@ bool V8ToGValue(GValue *gvalue, Local<Value> value) {
             return false;
         }
         g_value_set_param (gvalue, ParamSpec::FromWrapper(value));
-    } else if (G_VALUE_HOLDS_FLAGS (gvalue)) {
-        printf("G_VALUE_HOLDS_FLAGS");
-        g_assert_not_reached ();
     } else if (G_VALUE_HOLDS_POINTER (gvalue)) {
         printf("G_VALUE_HOLDS_POINTER");
         g_assert_not_reached ();
@@ -1138,9 +1549,11 @@ bool V8ToGValue(GValue *gvalue, Local<Value> value) {
 bool CanConvertV8ToGValue(GValue *gvalue, Local<Value> value) {
     if (G_VALUE_HOLDS_BOOLEAN (gvalue)) {
         return true;
-    } else if (G_VALUE_HOLDS_INT (gvalue) || G_VALUE_HOLDS_LONG (gvalue)) {
+    } else if (G_VALUE_HOLDS_CHAR (gvalue) || G_VALUE_HOLDS_UCHAR (gvalue)) {
         return true;
-    } else if (G_VALUE_HOLDS_UINT (gvalue)) {
+    } else if (G_VALUE_HOLDS_INT (gvalue) || G_VALUE_HOLDS_LONG (gvalue) || G_VALUE_HOLDS_INT64 (gvalue)) {
+        return true;
+    } else if (G_VALUE_HOLDS_UINT (gvalue) || G_VALUE_HOLDS_ULONG (gvalue) || G_VALUE_HOLDS_UINT64 (gvalue)) {
         return true;
     } else if (G_VALUE_HOLDS_FLOAT (gvalue)) {
         return true;
@@ -1152,16 +1565,16 @@ bool CanConvertV8ToGValue(GValue *gvalue, Local<Value> value) {
         return true;
     } else if (G_VALUE_HOLDS_ENUM (gvalue)) {
         return true;
+    } else if (G_VALUE_HOLDS_FLAGS (gvalue)) {
+        return true;
     } else if (G_VALUE_HOLDS_OBJECT (gvalue)) {
-        if (!ValueIsInstanceOfGType(value, G_VALUE_TYPE (gvalue))) {
+        if (!value->IsNull() && !ValueIsInstanceOfGType(value, G_VALUE_TYPE (gvalue))) {
             return false;
         }
     } else if (G_VALUE_HOLDS_BOXED (gvalue)) {
-        if (!ValueIsInstanceOfGType(value, G_VALUE_TYPE (gvalue))) {
+        if (!value->IsNull() && !ValueIsInstanceOfGType(value, G_VALUE_TYPE (gvalue))) {
             return false;
         }
-    } else if (G_VALUE_HOLDS_FLAGS (gvalue)) {
-        return false;
     } else if (G_VALUE_HOLDS_POINTER (gvalue)) {
         return false;
     } else if (G_VALUE_HOLDS_VARIANT (gvalue)) {
@@ -1178,10 +1591,22 @@ Local<Value> GValueToV8(const GValue *gvalue) {
             return New<Boolean>(true);
         else
             return New<Boolean>(false);
+    } else if (G_VALUE_HOLDS_CHAR (gvalue)) {
+        return New<Integer>(g_value_get_schar (gvalue));
+    } else if (G_VALUE_HOLDS_UCHAR (gvalue)) {
+        return New<v8::Uint32>(g_value_get_uchar (gvalue));
     } else if (G_VALUE_HOLDS_INT (gvalue)) {
         return New<Integer>(g_value_get_int (gvalue));
     } else if (G_VALUE_HOLDS_UINT (gvalue)) {
         return New<v8::Uint32>(g_value_get_uint (gvalue));
+    } else if (G_VALUE_HOLDS_LONG (gvalue)) {
+        return New<Number>(g_value_get_long (gvalue));
+    } else if (G_VALUE_HOLDS_ULONG (gvalue)) {
+        return New<Number>(g_value_get_ulong (gvalue));
+    } else if (G_VALUE_HOLDS_INT64 (gvalue)) {
+        return New<Number>(g_value_get_int64 (gvalue));
+    } else if (G_VALUE_HOLDS_UINT64 (gvalue)) {
+        return New<Number>(g_value_get_uint64 (gvalue));
     } else if (G_VALUE_HOLDS_FLOAT (gvalue)) {
         return New<Number>(g_value_get_float (gvalue));
     } else if (G_VALUE_HOLDS_DOUBLE (gvalue)) {
@@ -1194,13 +1619,26 @@ Local<Value> GValueToV8(const GValue *gvalue) {
             return Nan::EmptyString();
     } else if (G_VALUE_HOLDS_ENUM (gvalue)) {
         return New<Integer>(g_value_get_enum (gvalue));
+    } else if (G_VALUE_HOLDS_FLAGS (gvalue)) {
+        return New<v8::Uint32>(g_value_get_flags (gvalue));
+    } else if (G_VALUE_HOLDS_GTYPE (gvalue)) {
+        return New<Number>(g_value_get_gtype (gvalue));
+    } else if (G_VALUE_HOLDS_PARAM (gvalue)) {
+        return ParamSpec::FromGParamSpec (g_value_get_param (gvalue));
     } else if (G_VALUE_HOLDS_OBJECT (gvalue)) {
         return WrapperFromGObject (G_OBJECT (g_value_get_object (gvalue)));
+    } else if (G_VALUE_HOLDS (gvalue, G_TYPE_STRV)) {
+        char **strings = (char **) g_value_get_boxed (gvalue);
+        if (strings)
+            return StringArrayToV8 (strings, -1);
+        else
+            return Nan::Null();
     } else if (G_VALUE_HOLDS_BOXED (gvalue)) {
         GType type = G_VALUE_TYPE (gvalue);
         g_type_ensure(type);
         GIBaseInfo *info = g_irepository_find_by_gtype(NULL, type);
-        Local<Value> obj = WrapperFromBoxed(info, g_value_get_boxed(gvalue));
+        // The GValue keeps ownership of its boxed: the wrapper owns a copy
+        Local<Value> obj = WrapperFromBoxed(info, g_value_dup_boxed(gvalue));
         g_base_info_unref(info);
         return obj;
     } else {
@@ -1236,6 +1674,10 @@ static gpointer GIArgumentToHashPointer (const GIArgument *arg, GITypeInfo *type
     GITypeTag type_tag = GetStorageType(type_info);
 
     switch (type_tag) {
+        case GI_TYPE_TAG_BOOLEAN:
+            return GINT_TO_POINTER (arg->v_boolean);
+        case GI_TYPE_TAG_UNICHAR:
+            return GUINT_TO_POINTER (arg->v_uint32);
         case GI_TYPE_TAG_INT8:
             return GINT_TO_POINTER (arg->v_int8);
         case GI_TYPE_TAG_UINT8:
@@ -1265,6 +1707,12 @@ static void HashPointerToGIArgument (GIArgument *arg, GITypeInfo *type_info) {
     GITypeTag type_tag = GetStorageType (type_info);
 
     switch (type_tag) {
+        case GI_TYPE_TAG_BOOLEAN:
+            arg->v_boolean = (gboolean)GPOINTER_TO_INT (arg->v_pointer);
+            break;
+        case GI_TYPE_TAG_UNICHAR:
+            arg->v_uint32 = (guint32)GPOINTER_TO_UINT (arg->v_pointer);
+            break;
         case GI_TYPE_TAG_INT8:
             arg->v_int8 = (gint8)GPOINTER_TO_INT (arg->v_pointer);
             break;
@@ -1312,4 +1760,38 @@ static bool IsUint8Array (GITypeInfo *type_info) {
 }
 
 
+/**
+ * Transcodes @string to a newly allocated UTF-8 string, in a single pass
+ */
+char *V8ToUtf8 (Local<String> string) {
+    int size = string->Utf8Length() + 1;
+    char *data = (char *) g_malloc (size);
+
+    string->WriteUtf8 (data, size);
+    return data;
+}
+
+StringScratch::~StringScratch () {
+    g_slist_free_full (blocks, g_free);
+}
+
+/**
+ * Writes @string as UTF-8 to memory that lives as long as the scratch
+ */
+char *StringScratch::WriteUtf8 (Local<String> string) {
+    gsize size = string->Utf8Length() + 1;
+    char *data;
+
+    if (used + size <= INLINE_SIZE) {
+        data = buffer + used;
+        used += size;
+    } else {
+        data = (char *) g_malloc (size);
+        blocks = g_slist_prepend (blocks, data);
+    }
+
+    string->WriteUtf8 (data, size);
+    return data;
+}
+
 };
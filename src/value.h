@@ -14,8 +14,8 @@ namespace GNodeJS {
 Local<Value> GListToV8  (GITypeInfo *info, GList  *glist);
 Local<Value> GSListToV8 (GITypeInfo *info, GSList *glist);
 Local<Value> GHashToV8 (GITypeInfo *info, GHashTable *hash);
-Local<Value> ArrayToV8  (GITypeInfo *info, gpointer data, long length = -1);
-Local<Value> GIArgumentToV8 (GITypeInfo *type_info, GIArgument *argument, long length = -1);
+Local<Value> ArrayToV8  (GITypeInfo *info, gpointer data, long length = -1, gpointer *adopt = NULL);
+Local<Value> GIArgumentToV8 (GITypeInfo *type_info, GIArgument *argument, long length = -1, GITransfer transfer = GI_TRANSFER_EVERYTHING);
 
 bool         V8ToGIArgument (GITypeInfo *type_info, GIArgument *argument, Local<Value> value);
 bool         V8ToGIArgument (GITypeInfo *type_info, GIArgument *argument, Local<Value> value, bool may_be_null);
@@ -27,7 +27,37 @@ bool         V8ToGValue(GValue *gvalue, Local<Value> value) __attribute__((warn_
 Local<Value> GValueToV8(const GValue *gvalue);
 bool         CanConvertV8ToGValue(GValue *gvalue, Local<Value> value);
 
+bool         SetColumnarStructs (bool enabled);
+bool         SetHashAsMap (bool enabled);
+
+bool         IsTypedArrayElement (GITypeTag tag);
+bool         IsTypedArrayOf (GITypeTag tag, Local<Value> value);
+bool         GetArrayBufferViewData (GITypeInfo *type_info, Local<Value> value, void **data, long *length);
+Local<Value> MakeTypedArray (GITypeTag tag, Local<v8::ArrayBuffer> buffer, size_t length);
+
 bool         ValueHasInternalField  (Local<Value> value);
 bool         ValueIsInstanceOfGType (Local<Value> value, GType g_type);
 
+char *       V8ToUtf8 (Local<v8::String> string);
+
+/**
+ * Scratch memory for the UTF-8 strings of a single call. Strings are
+ * written to the inline buffer while it has room, and to blocks freed
+ * with the scratch otherwise.
+ */
+class StringScratch {
+public:
+    StringScratch () : used (0), blocks (NULL) {}
+    ~StringScratch ();
+
+    char *WriteUtf8 (Local<v8::String> string);
+
+private:
+    static const gsize INLINE_SIZE = 1024;
+
+    char    buffer[INLINE_SIZE];
+    gsize   used;
+    GSList *blocks;
+};
+
 };
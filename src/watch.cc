@@ -0,0 +1,297 @@
+/*
+ * watch.cc
+ */
+
+#include <string.h>
+
+#include "debug.h"
+#include "gi.h"
+#include "gobject.h"
+#include "loop.h"
+#include "util.h"
+#include "value.h"
+#include "watch.h"
+
+using v8::Array;
+using v8::Function;
+using v8::FunctionTemplate;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+using Nan::New;
+
+namespace GNodeJS {
+
+struct WatchedObject {
+    Watcher   *watcher;
+    GObject   *gobject;
+    gulong     handler_id;
+    GPtrArray *filter;   // property names (char*), or NULL to watch all properties
+    GPtrArray *changed;  // GParamSpec* changed since the last delivery
+};
+
+static void WatchedObjectFree (WatchedObject *watched) {
+    if (watched->filter)
+        g_ptr_array_unref (watched->filter);
+    g_ptr_array_unref (watched->changed);
+    g_free (watched);
+}
+
+static bool FilterContains (GPtrArray *filter, const char *name) {
+    for (guint i = 0; i < filter->len; i++) {
+        if (strcmp ((const char *) g_ptr_array_index (filter, i), name) == 0)
+            return true;
+    }
+    return false;
+}
+
+
+Nan::Persistent<Function> Watcher::constructor;
+
+static NAN_METHOD(WatcherAdd);
+static NAN_METHOD(WatcherRemove);
+static NAN_METHOD(WatcherClose);
+
+Local<Function> Watcher::GetConstructor() {
+    if (Watcher::constructor.IsEmpty()) {
+        auto tpl = Nan::New<FunctionTemplate>();
+        tpl->SetClassName(Nan::New("Watcher").ToLocalChecked());
+        tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+        Nan::SetPrototypeMethod(tpl, "add", WatcherAdd);
+        Nan::SetPrototypeMethod(tpl, "remove", WatcherRemove);
+        Nan::SetPrototypeMethod(tpl, "close", WatcherClose);
+
+        Watcher::constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
+    }
+    return Nan::New(Watcher::constructor);
+}
+
+Local<Value> Watcher::New (Local<Function> callback, guint interval) {
+    Local<Object> instance = Nan::NewInstance(Watcher::GetConstructor()).ToLocalChecked();
+    Watcher *watcher = new Watcher(callback, interval);
+    watcher->Wrap(instance);
+    return instance;
+}
+
+Watcher::Watcher (Local<Function> fn, guint interval_ms) {
+    callback.Reset(fn);
+    interval  = interval_ms;
+    source_id = 0;
+    objects   = g_hash_table_new (g_direct_hash, g_direct_equal);
+    pending   = g_ptr_array_new ();
+}
+
+Watcher::~Watcher () {
+    Close ();
+    g_hash_table_unref (objects);
+    g_ptr_array_unref (pending);
+    callback.Reset();
+}
+
+/**
+ * Starts watching @gobject. If @filter is not NULL, only the properties it
+ * names are recorded. The watcher keeps itself alive while it watches objects.
+ */
+void Watcher::AddObject (GObject *gobject, GPtrArray *filter) {
+    RemoveObject (gobject);
+
+    WatchedObject *watched = g_new0 (WatchedObject, 1);
+    watched->watcher = this;
+    watched->gobject = gobject;
+    watched->filter  = filter;
+    watched->changed = g_ptr_array_new ();
+    watched->handler_id = g_signal_connect (gobject, "notify", G_CALLBACK (Watcher::Notify), watched);
+    g_object_weak_ref (gobject, Watcher::Finalized, watched);
+
+    if (g_hash_table_size (objects) == 0)
+        Ref ();
+
+    g_hash_table_insert (objects, gobject, watched);
+}
+
+void Watcher::RemoveObject (GObject *gobject) {
+    WatchedObject *watched = (WatchedObject *) g_hash_table_lookup (objects, gobject);
+
+    if (watched == NULL)
+        return;
+
+    g_signal_handler_disconnect (gobject, watched->handler_id);
+    g_object_weak_unref (gobject, Watcher::Finalized, watched);
+    Forget (watched);
+}
+
+void Watcher::Forget (WatchedObject *watched) {
+    g_hash_table_remove (objects, watched->gobject);
+    g_ptr_array_remove (pending, watched);
+    WatchedObjectFree (watched);
+
+    if (g_hash_table_size (objects) == 0)
+        Unref ();
+}
+
+void Watcher::Close () {
+    GList *gobjects = g_hash_table_get_keys (objects);
+
+    for (GList *l = gobjects; l != NULL; l = l->next)
+        RemoveObject ((GObject *) l->data);
+
+    g_list_free (gobjects);
+
+    if (source_id != 0) {
+        g_source_remove (source_id);
+        source_id = 0;
+    }
+}
+
+void Watcher::Schedule () {
+    if (source_id != 0)
+        return;
+
+    if (interval > 0)
+        source_id = g_timeout_add (interval, Watcher::Flush, this);
+    else
+        source_id = g_idle_add (Watcher::Flush, this);
+}
+
+/**
+ * Converts the recorded changes and calls the JS callback with an array of
+ * { object, changedProperties }. Only changed properties are read.
+ */
+void Watcher::Deliver () {
+    Nan::HandleScope scope;
+
+    GPtrArray *batch = pending;
+    pending = g_ptr_array_new ();
+
+    Local<Array> changes = Nan::New<Array> (batch->len);
+
+    for (guint i = 0; i < batch->len; i++) {
+        WatchedObject *watched = (WatchedObject *) g_ptr_array_index (batch, i);
+        Local<Object> entry = Nan::New<Object> ();
+        Local<Object> properties = Nan::New<Object> ();
+
+        for (guint j = 0; j < watched->changed->len; j++) {
+            GParamSpec *pspec = (GParamSpec *) g_ptr_array_index (watched->changed, j);
+            GValue value = {};
+            g_value_init (&value, G_PARAM_SPEC_VALUE_TYPE (pspec));
+            g_object_get_property (watched->gobject, pspec->name, &value);
+
+            char *name = Util::ToCamelCase (pspec->name);
+            Nan::Set (properties, UTF8(name), GValueToV8 (&value));
+            g_free (name);
+            g_value_unset (&value);
+        }
+
+        g_ptr_array_set_size (watched->changed, 0);
+
+        Nan::Set (entry, UTF8("object"), WrapperFromGObject (watched->gobject));
+        Nan::Set (entry, UTF8("changedProperties"), properties);
+        Nan::Set (changes, i, entry);
+    }
+
+    g_ptr_array_unref (batch);
+
+    Local<Function> fn = Nan::New<Function> (callback);
+    Local<Object> self = Nan::GetCurrentContext()->Global();
+    Local<Value> args[] = { changes };
+
+    Nan::TryCatch try_catch;
+
+    Nan::Call (fn, self, 1, args);
+
+    if (try_catch.HasCaught()) {
+        GNodeJS::QuitLoopStack();
+        try_catch.ReThrow();
+    }
+}
+
+void Watcher::Notify (GObject *gobject, GParamSpec *pspec, gpointer user_data) {
+    WatchedObject *watched = (WatchedObject *) user_data;
+    Watcher *watcher = watched->watcher;
+
+    if (watched->filter != NULL && !FilterContains (watched->filter, pspec->name))
+        return;
+
+    for (guint i = 0; i < watched->changed->len; i++) {
+        if (g_ptr_array_index (watched->changed, i) == pspec)
+            return;
+    }
+
+    if (watched->changed->len == 0)
+        g_ptr_array_add (watcher->pending, watched);
+
+    g_ptr_array_add (watched->changed, pspec);
+    watcher->Schedule ();
+}
+
+void Watcher::Finalized (gpointer user_data, GObject *where_the_object_was) {
+    WatchedObject *watched = (WatchedObject *) user_data;
+    watched->watcher->Forget (watched);
+}
+
+gboolean Watcher::Flush (gpointer user_data) {
+    Watcher *watcher = (Watcher *) user_data;
+    watcher->source_id = 0;
+
+    if (watcher->pending->len > 0)
+        watcher->Deliver ();
+
+    return G_SOURCE_REMOVE;
+}
+
+
+static NAN_METHOD(WatcherAdd) {
+    Watcher *watcher = Nan::ObjectWrap::Unwrap<Watcher> (info.This ());
+    GObject *gobject = GObjectFromWrapper (info[0]);
+
+    if (!gobject) {
+        Nan::ThrowTypeError("Object is not a GObject");
+        return;
+    }
+
+    GPtrArray *filter = NULL;
+
+    if (info[1]->IsArray()) {
+        Local<Array> names = info[1].As<Array>();
+        filter = g_ptr_array_new_with_free_func (g_free);
+
+        for (uint32_t i = 0; i < names->Length(); i++) {
+            Nan::Utf8String name (Nan::Get(names, i).ToLocalChecked());
+            GParamSpec *pspec = FindProperty (gobject, *name);
+
+            if (pspec == NULL) {
+                char *message = g_strdup_printf("Unexistent property \"%s\"", *name);
+                Nan::ThrowError(message);
+                g_free(message);
+                g_ptr_array_unref (filter);
+                return;
+            }
+
+            g_ptr_array_add (filter, g_strdup (pspec->name));
+        }
+    }
+
+    watcher->AddObject (gobject, filter);
+    info.GetReturnValue().Set(info.This());
+}
+
+static NAN_METHOD(WatcherRemove) {
+    Watcher *watcher = Nan::ObjectWrap::Unwrap<Watcher> (info.This ());
+    GObject *gobject = GObjectFromWrapper (info[0]);
+
+    if (!gobject) {
+        Nan::ThrowTypeError("Object is not a GObject");
+        return;
+    }
+
+    watcher->RemoveObject (gobject);
+    info.GetReturnValue().Set(info.This());
+}
+
+static NAN_METHOD(WatcherClose) {
+    Watcher *watcher = Nan::ObjectWrap::Unwrap<Watcher> (info.This ());
+    watcher->Close ();
+}
+
+};
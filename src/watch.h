@@ -0,0 +1,53 @@
+/*
+ * watch.h
+ */
+
+#pragma once
+
+#include <node.h>
+#include <nan.h>
+#include <glib-object.h>
+
+using v8::Function;
+using v8::Local;
+using v8::Value;
+
+namespace GNodeJS {
+
+struct WatchedObject;
+
+/**
+ * Records property changes of many GObjects in native memory, and delivers
+ * them to JS as a single deduplicated batch per main loop iteration (or per
+ * interval, if one is given).
+ */
+class Watcher : public Nan::ObjectWrap {
+public:
+    Nan::Persistent<Function> callback;
+    guint       interval;
+    guint       source_id;
+    GHashTable *objects;  // GObject* => WatchedObject*
+    GPtrArray  *pending;  // WatchedObject* with changes, in order of first change
+
+    static Local<Value> New (Local<Function> callback, guint interval);
+
+    void AddObject    (GObject *gobject, GPtrArray *filter);
+    void RemoveObject (GObject *gobject);
+    void Forget       (WatchedObject *watched);
+    void Close        ();
+    void Schedule     ();
+    void Deliver      ();
+
+    static void     Notify    (GObject *gobject, GParamSpec *pspec, gpointer user_data);
+    static void     Finalized (gpointer user_data, GObject *where_the_object_was);
+    static gboolean Flush     (gpointer user_data);
+
+private:
+    Watcher (Local<Function> callback, guint interval);
+    ~Watcher ();
+
+    static Nan::Persistent<Function> constructor;
+    static Local<Function> GetConstructor ();
+};
+
+};
@@ -21,6 +21,19 @@ const common = require('./__common__.js')
 }
 
 
+/*
+ * IN-array from a Buffer or typed array
+ */
+{
+  const buffer = Buffer.from('hello')
+  const result = glib.base64Encode(buffer, buffer.length)
+  console.log('Result:', result)
+  common.assert(result === buffer.toString('base64'))
+
+  const bytes = new Uint8Array([ 104, 101, 108, 108, 111 ])
+  const checksum = glib.computeChecksumForData(glib.ChecksumType.MD5, bytes)
+  common.assert(checksum === '5d41402abc4b2a76b9719d911017c592', 'typed array checksum failed')
+}
 
 /*
  * OUT-array (array-length after)
@@ -39,12 +52,23 @@ const common = require('./__common__.js')
   const filepath = __filename
   const result = glib.fileGetContents(filepath)
   console.log('Result:', result)
-  const content = result[1].map(c => String.fromCharCode(c)).join('')
+  const content = Buffer.from(result[1].buffer, result[1].byteOffset, result[1].length).toString()
   const actualContent = fs.readFileSync(filepath).toString()
   common.assert(result[0] === true, 'glib_file_get_contents failed')
+  common.assert(result[1] instanceof Uint8Array, 'content is not a Uint8Array')
   common.assert(content === actualContent, 'file content is wrong')
 }
 
+/*
+ * RETURN-array (transfer full) is a typed array over the returned memory
+ */
+{
+  const result = glib.base64Decode(Buffer.from('hello').toString('base64'))
+  console.log('Result:', result)
+  common.assert(result instanceof Uint8Array, 'result is not a Uint8Array')
+  common.assert(Buffer.from(result).toString() === 'hello', 'decoded content is wrong')
+}
+
 /*
  * INOUT-array
  */
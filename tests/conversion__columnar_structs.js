@@ -0,0 +1,27 @@
+/*
+ * conversion__columnar_structs.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const Gdk = gi.require('Gdk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+
+common.describe('arrays of structs can be returned as columns', () => {
+  const keymap = Gdk.Keymap.getDefault()
+  const [, keys] = keymap.getEntriesForKeyval(Gdk.KEY_a)
+  const [, columns] = gi.columnar(() => keymap.getEntriesForKeyval(Gdk.KEY_a))
+
+  common.expect(columns.length, keys.length)
+  common.assert(columns.keycode instanceof Uint32Array, 'keycode is not a Uint32Array')
+  common.assert(columns.level instanceof Int32Array, 'level is not an Int32Array')
+
+  keys.forEach((key, i) => {
+    common.expect(columns.keycode[i], key.keycode)
+    common.expect(columns.group[i], key.group)
+    common.expect(columns.level[i], key.level)
+  })
+})
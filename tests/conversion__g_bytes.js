@@ -0,0 +1,29 @@
+/*
+ * conversion__g_bytes.js
+ */
+
+const gi = require('../lib/')
+const GLib = gi.require('GLib', '2.0')
+const common = require('./__common__.js')
+
+
+common.describe('GLib.Bytes.fromBuffer', () => {
+  const buffer = Buffer.from('hello')
+  const bytes = GLib.Bytes.fromBuffer(buffer)
+
+  common.expect(bytes.getSize(), 5)
+  common.expect(Buffer.compare(bytes.toBuffer(), buffer), 0)
+  common.expect(bytes.toBuffer().toString(), 'hello')
+})
+
+common.describe('GLib.Bytes.prototype.toBuffer: keeps the bytes alive', () => {
+  const buffer = (() => GLib.Bytes.fromBuffer(Buffer.from('world')).toBuffer())()
+
+  global.gc()
+  common.expect(buffer.toString(), 'world')
+})
+
+common.describe('GLib.Bytes.fromBuffer: not a buffer',
+  common.mustThrow(/not a Buffer/, () => {
+    GLib.Bytes.fromBuffer('hello')
+  }))
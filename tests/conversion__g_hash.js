@@ -32,3 +32,15 @@ const common = require('./__common__.js')
   common.assert(result.name === 'John')
   common.assert(result.age === '33')
 }
+
+/*
+ * as Map
+ */
+{
+  const result = gi.hashAsMap(() => soup.formDecode('age=33&name=John'))
+  common.assert(result instanceof Map)
+  common.assert(result.get('name') === 'John')
+  common.assert(result.get('age') === '33')
+
+  common.assert(soup.formEncodeHash(result) === 'age=33&name=John')
+}
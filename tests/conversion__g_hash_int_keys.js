@@ -0,0 +1,29 @@
+/*
+ * conversion__g_hash_int_keys.js
+ */
+
+
+const gi = require('../lib/')
+const common = require('./__common__.js')
+
+let GIMarshallingTests
+try {
+  GIMarshallingTests = gi.require('GIMarshallingTests')
+} catch(e) {
+  common.skip()
+}
+
+common.describe('GHashTable<int, int>: from Map', () => {
+  GIMarshallingTests.ghashtableIntNoneIn(new Map([[-1, 1], [0, 0], [1, -1], [2, -2]]))
+})
+
+common.describe('GHashTable<int, int>: from object', () => {
+  GIMarshallingTests.ghashtableIntNoneIn({ '-1': 1, 0: 0, 1: -1, 2: -2 })
+})
+
+common.describe('GHashTable<int, int>: as return value', () => {
+  const result = gi.hashAsMap(() => GIMarshallingTests.ghashtableIntNoneReturn())
+  common.assert(result instanceof Map)
+  common.expect(result.get(-1), 1)
+  common.expect(result.get(2), -2)
+})
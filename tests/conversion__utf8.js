@@ -0,0 +1,20 @@
+/*
+ * conversion__utf8.js
+ */
+
+const gi = require('../lib/')
+const GLib = gi.require('GLib', '2.0')
+const common = require('./__common__.js')
+
+
+common.describe('utf8 arguments', () => {
+  common.expect(GLib.utf8Strreverse('abc', -1), 'cba')
+  common.expect(GLib.utf8Strreverse('été ✓', -1), '✓ été')
+  common.expect(GLib.utf8Strreverse('', -1), '')
+})
+
+common.describe('utf8 arguments: longer than the call scratch', () => {
+  const input = 'ab'.repeat(1000)
+  common.expect(GLib.utf8Strreverse(input, -1), 'ba'.repeat(1000))
+  common.expect(GLib.strcmp0(input, input), 0)
+})
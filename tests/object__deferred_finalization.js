@@ -0,0 +1,35 @@
+/*
+ * object__deferred_finalization.js
+ */
+
+const gi = require('../lib/')
+const Gdk = gi.require('Gdk', '3.0')
+const common = require('./__common__.js')
+
+
+function allocate(count) {
+  for (let i = 0; i < count; i++)
+    new Gdk.RGBA({ red: 1 })
+}
+
+const before = gi.getStats().finalization
+
+allocate(20000)
+global.gc()
+
+const collected = gi.getStats().finalization
+
+common.describe('finalization: queued during GC', () => {
+  common.assert(collected.pending > 0, 'nothing was queued')
+  common.expect(collected.finalized, before.finalized)
+})
+
+setTimeout(() => {
+  common.describe('finalization: drained in slices', () => {
+    const after = gi.getStats().finalization
+    common.expect(after.pending, 0)
+    common.assert(after.finalized >= before.finalized + collected.pending)
+    common.assert(after.maxPending >= collected.pending)
+    common.assert(after.maxSliceTime > 0)
+  })
+}, 100)
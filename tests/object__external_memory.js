@@ -0,0 +1,70 @@
+/*
+ * object__external_memory.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+const SIZE = 64 * 1024 * 1024
+
+/* Hooks are global: each test removes the ones it registers */
+function withExternalSize(typeName, size, fn) {
+  gi.registerExternalSize(typeName, () => size)
+  try {
+    fn()
+  } finally {
+    gi.unregisterExternalSize(typeName)
+  }
+}
+
+
+common.describe('external memory is reported on wrap', () => withExternalSize('GtkAdjustment', SIZE, () => {
+  const before = process.memoryUsage().external
+
+  let adjustment = new Gtk.Adjustment()
+  const during = process.memoryUsage().external
+  console.log('External memory:', before, during)
+
+  common.assert(during - before >= SIZE, 'Expected external memory to grow')
+
+  adjustment = null
+  global.gc()
+
+  const after = process.memoryUsage().external
+  console.log('External memory after GC:', after)
+
+  common.assert(during - after >= SIZE, 'Expected external memory to shrink')
+}))
+
+common.describe('external memory applies to subtypes', () => withExternalSize('GtkWidget', SIZE, () => {
+  const before = process.memoryUsage().external
+  const label = new Gtk.Label()
+  const during = process.memoryUsage().external
+
+  common.assert(during - before >= SIZE, 'Expected external memory to grow')
+  label.release()
+}))
+
+common.describe('external memory above 2 GiB', () => withExternalSize('GtkAdjustment', 3 * 1024 * SIZE / 64, () => {
+  const before = process.memoryUsage().external
+  const adjustment = new Gtk.Adjustment()
+  const during = process.memoryUsage().external
+
+  common.assert(during - before >= 3 * 1024 * 1024 * 1024, 'Expected external memory to grow by 3 GiB')
+
+  adjustment.release()
+  common.assert(process.memoryUsage().external - before < SIZE, 'Expected external memory to shrink')
+}))
+
+common.describe('gi.unregisterExternalSize', () => {
+  withExternalSize('GtkAdjustment', SIZE, () => {})
+
+  const before = process.memoryUsage().external
+  const adjustment = new Gtk.Adjustment()
+
+  common.assert(process.memoryUsage().external - before < SIZE, 'Expected no external memory')
+  adjustment.release()
+})
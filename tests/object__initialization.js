@@ -28,3 +28,11 @@ common.describe('WrapperFromGObject', () => {
   const result = Gtk.Button.newFromStock(Gtk.STOCK_YES)
   console.log(result)
 })
+
+
+common.describe('new GObject({ ... }): JS-style property names', () => {
+  const adjustment = new Gtk.Adjustment({ upper: 100, stepIncrement: 5, 'page-size': 10 })
+
+  common.expect(adjustment.stepIncrement, 5)
+  common.expect(adjustment.pageSize, 10)
+})
@@ -0,0 +1,47 @@
+/*
+ * object__properties.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+
+common.describe('GObject.setProperties', () => {
+  const window = new Gtk.Window()
+
+  let notifications = 0
+  window.on('notify::title', () => notifications++)
+
+  window.setProperties({ title: 'Bulk', 'default-width': 300, defaultHeight: 200 })
+
+  common.expect(window.title, 'Bulk')
+  common.expect(window.defaultWidth, 300)
+  common.expect(window.defaultHeight, 200)
+  common.expect(notifications, 1)
+})
+
+common.describe('GObject.getProperties', () => {
+  const window = new Gtk.Window({ title: 'Bulk' })
+  window.defaultWidth = 320
+
+  const result = window.getProperties(['title', 'defaultWidth'])
+  console.log('Result:', result)
+
+  common.expect(result.title, 'Bulk')
+  common.expect(result.defaultWidth, 320)
+})
+
+common.describe('GObject.setProperties: invalid property',
+  common.mustThrow('Unexistent property "notAProperty"', () => {
+    const window = new Gtk.Window()
+    window.setProperties({ title: 'Bulk', notAProperty: true })
+  }))
+
+common.describe('GObject.getProperties: write-only property',
+  common.mustThrow('Property "background" is not readable', () => {
+    const renderer = new Gtk.CellRendererText()
+    renderer.getProperties(['background'])
+  }))
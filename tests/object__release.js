@@ -0,0 +1,47 @@
+/*
+ * object__release.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const Gdk = gi.require('Gdk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+
+common.describe('GObject.release', () => {
+  const label = new Gtk.Label({ label: 'text' })
+  label.release()
+  label.release() // no-op
+
+  common.mustThrow(/instance has been released/, () => {
+    label.getText()
+  })()
+  common.mustThrow(/instance has been released/, () => {
+    label.label
+  })()
+})
+
+common.describe('Boxed.release', () => {
+  const color = new Gdk.RGBA()
+  color.release()
+  color.release() // no-op
+
+  common.mustThrow(/instance has been released/, () => {
+    color.parse('#ff0000')
+  })()
+})
+
+common.describe('gi.scope', () => {
+  let inner
+  const kept = gi.scope(() => {
+    inner = new Gtk.Label({ label: 'inner' })
+    return new Gtk.Label({ label: 'kept' })
+  })
+
+  common.expect(kept.getText(), 'kept')
+  common.mustThrow(/instance has been released/, () => {
+    inner.getText()
+  })()
+})
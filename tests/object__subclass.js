@@ -0,0 +1,60 @@
+/*
+ * object__subclass.js
+ */
+
+const gi = require('../lib/')
+const GObject = gi.require('GObject', '2.0')
+const Gio = gi.require('Gio', '2.0')
+const Gtk = gi.require('Gtk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+
+class NumberList extends GObject.Object {
+  vfunc_getItemType() {
+    return Gtk.Label.gtype
+  }
+  vfunc_getNItems() {
+    return 10000
+  }
+  vfunc_getItem(position) {
+    return new Gtk.Label({ label: String(position) })
+  }
+}
+
+gi.registerClass(NumberList, { GTypeName: 'NodeGtkTestNumberList', Implements: [Gio.ListModel] })
+
+
+common.describe('registerClass: gtype', () => {
+  common.assert(typeof NumberList.gtype === 'number')
+  common.assert(NumberList.gtype !== GObject.Object.gtype)
+
+  const list = new NumberList()
+  common.expect(list.__gtype__, NumberList.gtype)
+  common.assert(list instanceof NumberList)
+})
+
+common.describe('registerClass: duplicate type name', common.mustThrow(
+  'Type "NodeGtkTestNumberList" is already registered', () => {
+    class Other extends GObject.Object {}
+    gi.registerClass(Other, { GTypeName: 'NodeGtkTestNumberList' })
+  }))
+
+common.describe('registerClass: interface vfuncs', () => {
+  const list = new NumberList()
+
+  common.expect(list.getNItems(), 10000)
+  common.expect(list.getItemType(), Gtk.Label.gtype)
+  common.expect(list.getItem(42).label, '42')
+})
+
+common.describe('registerClass: model backs a view', () => {
+  const list = new NumberList()
+  const box = new Gtk.ListBox()
+
+  box.bindModel(list, (item) => new Gtk.Label({ label: item.label }))
+
+  common.expect(box.getChildren().length, 10000)
+  common.expect(box.getRowAtIndex(9999).getChild().label, '9999')
+})
@@ -0,0 +1,37 @@
+/*
+ * object__toggle_damping.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+
+function counters() {
+  return gi.getStats().toggles.GtkLabel || { toggles: 0, weakened: 0, strengthened: 0 }
+}
+
+common.describe('toggle refs: weakening is deferred to the next GC', () => {
+  const box = new Gtk.Box()
+  const label = new Gtk.Label({ label: 'text' })
+  const before = counters()
+
+  for (let i = 0; i < 1000; i++) {
+    box.add(label)
+    box.remove(label)
+  }
+
+  const after = counters()
+  const toggles = after.toggles - before.toggles
+  const changes = (after.weakened - before.weakened) + (after.strengthened - before.strengthened)
+
+  common.assert(toggles >= 2000, `expected 2000 toggles, got ${toggles}`)
+  common.assert(changes < toggles / 10, `${changes} weakness changes for ${toggles} toggles`)
+
+  global.gc()
+
+  common.assert(counters().weakened > after.weakened, 'not weakened at GC')
+  common.expect(label.label, 'text')
+})
@@ -0,0 +1,44 @@
+/*
+ * object__watch.js
+ */
+
+const gi = require('../lib/')
+const GLib = gi.require('GLib', '2.0')
+const Gtk = gi.require('Gtk', '3.0')
+const common = require('./__common__.js')
+
+gi.startLoop()
+Gtk.init()
+
+const loop = new GLib.MainLoop(null, false)
+const adjustment = new Gtk.Adjustment({ lower: 0, upper: 1000 })
+const other = new Gtk.Adjustment({ lower: 0, upper: 1000 })
+
+let batches = 0
+
+const watcher = gi.watch((changes) => {
+  batches++
+  console.log('Changes:', changes)
+
+  common.expect(changes.length, 1)
+  common.assert(changes[0].object === adjustment, 'changed object is not the adjustment')
+  common.expect(changes[0].changedProperties.value, 100)
+  common.assert(!('upper' in changes[0].changedProperties), 'upper is not watched')
+
+  setTimeout(() => {
+    common.expect(batches, 1)
+    watcher.close()
+    loop.quit()
+  }, 50)
+})
+
+watcher.add(adjustment, ['value'])
+
+for (let i = 1; i <= 100; i++)
+  adjustment.value = i
+adjustment.upper = 2000
+
+// Not watched
+other.value = 5
+
+loop.run()
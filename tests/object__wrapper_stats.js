@@ -0,0 +1,61 @@
+/*
+ * object__wrapper_stats.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const Gdk = gi.require('Gdk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+
+common.describe('gi.getStats: GObject wrappers', () => {
+  const before = gi.getStats().wrappers.objects.live
+
+  const labels = []
+  for (let i = 0; i < 1000; i++)
+    labels.push(new Gtk.Label({ label: String(i) }))
+
+  const stats = gi.getStats().wrappers.objects
+  common.expect(stats.live, before + 1000)
+  common.assert(stats.capacity >= stats.live)
+
+  labels.forEach(label => label.release())
+  common.expect(gi.getStats().wrappers.objects.live, before)
+})
+
+common.describe('gi.getStats: boxed wrappers', () => {
+  const before = gi.getStats().wrappers.boxed.live
+
+  const colors = []
+  for (let i = 0; i < 1000; i++)
+    colors.push(new Gdk.RGBA())
+
+  common.expect(gi.getStats().wrappers.boxed.live, before + 1000)
+
+  colors.forEach(color => color.release())
+  common.expect(gi.getStats().wrappers.boxed.live, before)
+})
+
+common.describe('gi.getStats: records are reused', () => {
+  const { capacity } = gi.getStats().wrappers.objects
+
+  for (let i = 0; i < 10; i++)
+    new Gtk.Label().release()
+
+  common.expect(gi.getStats().wrappers.objects.capacity, capacity)
+})
+
+common.describe('gi.getStats: interned strings', () => {
+  const label = new Gtk.Label()
+  label.getName()
+
+  const before = gi.getStats().strings
+  for (let i = 0; i < 10; i++)
+    common.expect(label.getName(), 'GtkLabel')
+
+  const after = gi.getStats().strings
+  common.expect(after.hits, before.hits + 10)
+  common.assert(after.entries <= after.capacity)
+})
@@ -0,0 +1,114 @@
+/*
+ * signal__borrowed_boxed.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const Pango = gi.require('Pango')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+
+common.describe('boxed signal arguments are copied when they escape', () => {
+  const buffer = new Gtk.TextBuffer()
+  let escaped
+  let offsetInHandler
+
+  buffer.setText('hello', -1)
+  buffer.on('insert-text', (location, text, length) => {
+    offsetInHandler = location.getOffset()
+    escaped = location
+  })
+
+  buffer.insertAtCursor(' world', -1)
+  buffer.setText('', -1)
+
+  common.expect(offsetInHandler, 5)
+  common.expect(escaped.getOffset(), 5)
+})
+
+common.describe('boxed signal arguments captured by a closure are copied', () => {
+  const buffer = new Gtk.TextBuffer()
+  let getOffset
+
+  buffer.setText('hello', -1)
+  buffer.on('insert-text', (location, text, length) => {
+    getOffset = () => location.getOffset()
+  })
+
+  buffer.insertAtCursor(' world', -1)
+  buffer.setText('', -1)
+
+  common.expect(getOffset(), 5)
+})
+
+common.describe('boxed signal arguments can be kept', () => {
+  const buffer = new Gtk.TextBuffer()
+  let kept
+
+  buffer.setText('hello', -1)
+  buffer.on('insert-text', (location, text, length) => {
+    kept = gi.keep(location)
+  })
+
+  buffer.insertAtCursor(' world', -1)
+  buffer.setText('', -1)
+
+  common.expect(kept.getOffset(), 5)
+})
+
+common.describe('buffers over boxed signal arguments outlive the handler', () => {
+  const buffer = new Gtk.TextBuffer()
+  let view
+  let snapshot
+
+  buffer.setText('hello', -1)
+  buffer.on('insert-text', (location, text, length) => {
+    view = new Uint8Array(gi.getStructBuffer(location))
+    snapshot = Array.from(view)
+  })
+
+  buffer.insertAtCursor(' world', -1)
+  buffer.setText('', -1)
+  global.gc()
+
+  common.expect(view.length, snapshot.length)
+  common.expect(Array.from(view).join(), snapshot.join())
+})
+
+common.describe('nested wrappers follow the struct they were read from', () => {
+  const list = new Pango.AttrList()
+  list.insert(Pango.attrWeightNew(Pango.Weight.BOLD))
+  let klass
+  let type
+
+  list.filter(attribute => {
+    klass = attribute.klass
+    type = klass.type
+    gi.keep(attribute)
+    return false
+  })
+
+  common.expect(klass.type, type)
+})
+
+common.describe('nested wrappers read in an inner callback are lent by their owner', () => {
+  const list = new Pango.AttrList()
+  list.insert(Pango.attrWeightNew(Pango.Weight.BOLD))
+  const inner = new Pango.AttrList()
+  inner.insert(Pango.attrWeightNew(Pango.Weight.LIGHT))
+  let klass
+  let typeInHandler
+
+  list.filter(attribute => {
+    inner.filter(() => {
+      klass = attribute.klass
+      return false
+    })
+    typeInHandler = klass.type
+    return false
+  })
+
+  common.expect(klass.type, typeInHandler)
+})
@@ -0,0 +1,48 @@
+/*
+ * signal__emit.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+
+common.describe('GObject.emit: no arguments', () => {
+  const button = new Gtk.Button()
+  let count = 0
+  button.on('clicked', () => count++)
+
+  button.emit('clicked')
+  button.emit('clicked')
+
+  common.expect(count, 2)
+})
+
+common.describe('GObject.emit: arguments', () => {
+  const entry = new Gtk.Entry()
+  let inserted
+  entry.on('insert-at-cursor', (text) => { inserted = text })
+
+  entry.emit('insert-at-cursor', 'hello')
+
+  common.expect(inserted, 'hello')
+})
+
+common.describe('GObject.emit: return value', () => {
+  const button = new Gtk.Button()
+  button.on('mnemonic-activate', (groupCycling) => groupCycling)
+
+  common.expect(button.emit('mnemonic-activate', true), true)
+})
+
+common.describe('GObject.emit: unknown signal',
+  common.mustThrow('Signal "not-a-signal" not found for instance of GtkButton', () => {
+    new Gtk.Button().emit('not-a-signal')
+  }))
+
+common.describe('GObject.emit: missing arguments',
+  common.mustThrow('Signal "insert-at-cursor" expects 1 arguments, got 0', () => {
+    new Gtk.Entry().emit('insert-at-cursor')
+  }))
@@ -0,0 +1,62 @@
+/*
+ * signal__listeners.js
+ */
+
+const gi = require('../lib/')
+const Gtk = gi.require('Gtk', '3.0')
+const common = require('./__common__.js')
+
+Gtk.init()
+
+
+common.describe('GObject.once re-entrant emission', () => {
+  const button = new Gtk.Button()
+  let count = 0
+
+  button.once('clicked', () => {
+    count++
+    button.clicked()
+  })
+  button.clicked()
+  button.clicked()
+
+  common.expect(count, 1)
+})
+
+common.describe('GObject.off removes a single listener', () => {
+  const button = new Gtk.Button()
+  let count = 0
+  const onClick = () => count++
+
+  button.on('clicked', onClick)
+  button.on('clicked', onClick)
+  button.off('clicked', onClick)
+  button.clicked()
+
+  common.expect(count, 1)
+})
+
+common.describe('GObject.removeAllListeners', () => {
+  const button = new Gtk.Button()
+  let clicks = 0
+  let notifications = 0
+
+  button.on('clicked', () => clicks++)
+  button.once('clicked', () => clicks++)
+  button.on('notify::label', () => notifications++)
+
+  button.removeAllListeners('clicked')
+  button.clicked()
+  button.label = 'changed'
+  common.expect(clicks, 0)
+  common.expect(notifications, 1)
+
+  button.removeAllListeners()
+  button.label = 'changed again'
+  common.expect(notifications, 1)
+})
+
+common.describe('GObject.on returns the instance', () => {
+  const button = new Gtk.Button()
+  common.expect(button.on('clicked', () => {}), button)
+})
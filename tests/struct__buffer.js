@@ -0,0 +1,51 @@
+/*
+ * struct__buffer.js
+ */
+
+const gi = require('../lib/')
+const Gdk = gi.require('Gdk', '3.0')
+const common = require('./__common__.js')
+
+
+common.describe('gi.getStructLayout', () => {
+  const layout = gi.getStructLayout(Gdk.RGBA)
+  const names = layout.fields.map(f => f.name)
+
+  common.expect(layout.size, 32)
+  common.expect(names.join(','), 'red,green,blue,alpha')
+  layout.fields.forEach((field, i) => {
+    common.expect(field.offset, i * 8)
+    common.expect(field.size, 8)
+    common.expect(field.type, 'gdouble')
+  })
+})
+
+common.describe('gi.getStructBuffer', () => {
+  const color = new Gdk.RGBA()
+  color.parse('#ff8000')
+
+  const view = new Float64Array(gi.getStructBuffer(color))
+  common.expect(view[0], 1)
+  common.expect(view[2], 0)
+
+  view[3] = 0.5
+  common.expect(color.alpha, 0.5)
+})
+
+common.describe('gi.getStructBuffer: keeps the instance alive', () => {
+  const view = new DataView((() => {
+    const color = new Gdk.RGBA()
+    color.red = 0.25
+    return gi.getStructBuffer(color)
+  })())
+
+  global.gc()
+  common.expect(view.getFloat64(0, true), 0.25)
+})
+
+common.describe('gi.getStructBuffer: released instance',
+  common.mustThrow(/instance has been released/, () => {
+    const color = new Gdk.RGBA()
+    color.release()
+    gi.getStructBuffer(color)
+  }))
@@ -33,6 +33,20 @@ common.describe('with constructor (arguments)', () => {
     }))
 })
 
+common.describe('with constructor (reused)', () => {
+  for (let i = 0; i < 1000; i++) {
+    const border = new Gtk.Border()
+    border.left = i
+    common.expect(border.left, i)
+  }
+
+  // A failed call doesn't break later ones
+  common.mustThrow('Not enough arguments; expected 4, have 0', () => {
+    new Gtk.Gradient()
+  })()
+  common.assert(new Gtk.Gradient(0.1, 0.5, 2, 3) instanceof Gtk.Gradient)
+})
+
 common.describe('without constructor, size > 0', () => {
   const rgba = new Gdk.RGBA()
   rgba.red = 200 / 255
@@ -20,3 +20,65 @@ const common = require('./__common__.js')
   console.log('Result:', result)
   common.assert(result === 100)
 }
+
+/*
+ * nested structs are views
+ */
+{
+  const Gtk = gi.require('Gtk')
+  const attributes = new Gtk.TextAttributes()
+  attributes.appearance.fgColor.red = 1000
+
+  const result = attributes.appearance.fgColor.red
+  console.log('Result:', result)
+  common.assert(result === 1000)
+}
+
+/*
+ * fixed-size arrays are typed arrays
+ */
+{
+  const coord = new Gdk.TimeCoord()
+  const axes = coord.axes
+  common.assert(axes instanceof Float64Array)
+  common.assert(axes.length === 128)
+
+  axes[3] = 0.5
+  common.assert(coord.axes[3] === 0.5)
+}
+
+/*
+ * views keep their parent alive
+ */
+{
+  let axes = (() => new Gdk.TimeCoord().axes)()
+  global.gc()
+  axes[0] = 1
+  common.assert(axes[0] === 1)
+}
+
+/*
+ * structs without GType share one class, even when wrapped before it is loaded
+ */
+{
+  const Gtk = gi.require('Gtk')
+  const attributes = new Gtk.TextAttributes()
+  const first = attributes.appearance
+  const second = attributes.appearance
+
+  common.assert(Object.getPrototypeOf(first) === Object.getPrototypeOf(second))
+  common.assert(first instanceof Gtk.TextAppearance)
+}
+
+/*
+ * field names are camelCased as method names are (lodash)
+ */
+{
+  const config = new GLib.ScannerConfig()
+  const names = gi.getStructLayout(GLib.ScannerConfig).fields.map(f => f.name)
+  console.log('Result:', names)
+
+  common.assert(names.includes('scanIdentifier1Char'))
+  common.assert(names.includes('storeInt64'))
+  common.assert('scanIdentifier1Char' in config)
+}
@@ -0,0 +1,58 @@
+/*
+ * struct__inline.js
+ */
+
+const gi = require('../lib/')
+const Gdk = gi.require('Gdk', '3.0')
+const common = require('./__common__.js')
+
+let MessageChannel
+try {
+  MessageChannel = require('worker_threads').MessageChannel
+} catch (e) {}
+
+
+common.describe('structs without constructor nor GType are stored inline', () => {
+  const before = gi.getStats().wrappers.boxed.live
+
+  const geometries = []
+  for (let i = 0; i < 1000; i++) {
+    const geometry = new Gdk.Geometry()
+    geometry.minWidth = i
+    geometries.push(geometry)
+  }
+
+  common.expect(gi.getStats().wrappers.boxed.live, before)
+  common.expect(geometries[500].minWidth, 500)
+})
+
+common.describe('structs with a GType keep their record', () => {
+  const before = gi.getStats().wrappers.boxed.live
+  const color = new Gdk.RGBA()
+
+  common.expect(gi.getStats().wrappers.boxed.live, before + 1)
+  color.release()
+})
+
+common.describe('gi.getStructBuffer: inline struct', () => {
+  const geometry = new Gdk.Geometry()
+  geometry.minWidth = 42
+
+  const buffer = gi.getStructBuffer(geometry)
+  common.expect(new Int32Array(buffer)[0], 42)
+
+  if (!MessageChannel)
+    return console.log('Detaching not supported, skipped')
+
+  // Detaching the buffer (if allowed) leaves the struct usable
+  const { port1 } = new MessageChannel()
+  try {
+    port1.postMessage(buffer, [buffer])
+  } catch (e) {
+    console.log('Not transferable:', e.message)
+  }
+  port1.close()
+
+  common.expect(geometry.minWidth, 42)
+  common.expect(new Int32Array(gi.getStructBuffer(geometry))[0], 42)
+})